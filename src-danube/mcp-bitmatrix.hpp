@@ -0,0 +1,225 @@
+/**************************************************************************
+ *                                                                        *
+ *                                                                        *
+ *	         Multiple Classification Project (MCP)                    *
+ *                                                                        *
+ *	Author:   Miki Hermann                                            *
+ *	e-mail:   hermann@lix.polytechnique.fr                            *
+ *	Address:  LIX (CNRS UMR 7161), Ecole Polytechnique, France        *
+ *                                                                        *
+ *	Author: Gernot Salzer                                             *
+ *	e-mail: gernot.salzer@tuwien.ac.at                                *
+ *	Address: Technische Universitaet Wien, Vienna, Austria            *
+ *                                                                        *
+ *	Version: all                                                      *
+ *      File:    mcp-bitmatrix.hpp                                        *
+ *                                                                        *
+ *      Copyright (c) 2019 - 2025                                         *
+ *                                                                        *
+ * Packed Boolean matrix: all rows of a group are kept in one cache line  *
+ * aligned word buffer with a fixed stride, so that scanning a matrix is  *
+ * a linear walk through memory instead of chasing one pointer per row.   *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include "mcp-bits.hpp"
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+// read-only view of one row of a packed matrix
+class RowView {
+private:
+  const Word *words;
+  size_t nbits;
+
+public:
+  RowView (const Word *w, const size_t n) : words(w), nbits(n) {}
+
+  inline size_t size () const { return nbits; }
+  inline size_t nwords () const { return num_words(nbits); }
+  inline const Word* data () const { return words; }
+  inline bool operator[] (const size_t i) const {
+    return (words[i / WORDBITS] >> (i % WORDBITS)) & 1;
+  }
+};
+
+class BitMatrix {
+private:
+  size_t ncols = 0;		// number of bits in a row
+  size_t stride = 0;		// number of words in a row
+  size_t nrows = 0;
+  Words words;
+
+public:
+  BitMatrix () = default;
+  explicit BitMatrix (const size_t n) : ncols(n), stride(num_words(n)) {}
+
+  inline size_t size () const { return nrows; }
+  inline bool empty () const { return nrows == 0; }
+  inline size_t num_cols () const { return ncols; }
+  inline size_t row_stride () const { return stride; }
+
+  inline RowView operator[] (const size_t i) const {
+    return RowView(words.data() + i * stride, ncols);
+  }
+  inline const Word* row (const size_t i) const { return words.data() + i * stride; }
+  inline Word* row (const size_t i) { return words.data() + i * stride; }
+
+  inline bool get (const size_t i, const size_t j) const {
+    return (words[i * stride + j / WORDBITS] >> (j % WORDBITS)) & 1;
+  }
+  inline void set (const size_t i, const size_t j) {
+    words[i * stride + j / WORDBITS] |= Word(1) << (j % WORDBITS);
+  }
+
+  inline void reserve (const size_t n) { words.reserve(n * stride); }
+  inline void clear () { words.clear(); nrows = 0; }
+
+  // appends a row of zeros and returns its words
+  // the pointer is valid until the next append
+  inline Word* append () {
+    words.resize(words.size() + stride, 0);
+    return words.data() + nrows++ * stride;
+  }
+
+  // appends a row given by its words; unused bits must be 0
+  inline void append (const Word *w) {
+    words.insert(words.end(), w, w + stride);
+    ++nrows;
+  }
+
+  // appends all rows of a matrix with the same number of columns
+  inline void append (const BitMatrix &M) {
+    words.insert(words.end(), M.words.cbegin(), M.words.cend());
+    nrows += M.nrows;
+  }
+
+  // keeps only the columns selected by sect, in place
+  // the selected columns are copied run by run, a word at a time;
+  // rows only shrink, so row i is always written before row i+1 is read
+  void restrict (const Word *sect) {
+    struct Run { size_t from, to, len; };
+    vector<Run> runs;
+    size_t kept = 0;
+    for (size_t j = 0; j < ncols; ) {
+      if (! ((sect[j / WORDBITS] >> (j % WORDBITS)) & 1)) {
+	++j;
+	continue;
+      }
+      size_t e = j + 1;
+      while (e < ncols && ((sect[e / WORDBITS] >> (e % WORDBITS)) & 1))
+	++e;
+      runs.push_back({j, kept, e - j});
+      kept += e - j;
+      j = e;
+    }
+    const size_t nstride = num_words(kept);
+    vector<Word> temp(nstride);
+    for (size_t i = 0; i < nrows; ++i) {
+      fill(temp.begin(), temp.end(), 0);
+      const Word *r = row(i);
+      for (const Run &run : runs)
+	bits_copy(temp.data(), run.to, r, run.from, run.len);
+      copy(temp.cbegin(), temp.cend(), words.begin() + i * nstride);
+    }
+    ncols = kept;
+    stride = nstride;
+    words.resize(nrows * stride);
+  }
+
+  // sorts the rows lexicographically, column 0 first
+  void sort () {
+    vector<size_t> perm(nrows);
+    iota(perm.begin(), perm.end(), 0);
+    std::sort(perm.begin(), perm.end(),
+	      [this] (const size_t a, const size_t b) {
+		return bits_less(row(a), row(b), stride);
+	      });
+    Words sorted(words.size());
+    for (size_t i = 0; i < nrows; ++i)
+      copy(row(perm[i]), row(perm[i]) + stride, sorted.begin() + i * stride);
+    words = move(sorted);
+  }
+
+  // the transposed matrix, i.e., the column index of this one:
+  // row j is the bitmap of the rows having a 1 in column j
+  BitMatrix transpose () const {
+    BitMatrix C(nrows);
+    C.nrows = ncols;
+    C.words.assign(C.nrows * C.stride, 0);
+    for (size_t i = 0; i < nrows; ++i) {
+      const Word *r = row(i);
+      for (size_t w = 0; w < stride; ++w)
+	for (Word bits = r[w]; bits != 0; bits &= bits - 1)
+	  C.set(w * WORDBITS + ctz64(bits), i);
+    }
+    return C;
+  }
+
+  // removes consecutive duplicate rows, i.e., all duplicates after sort()
+  void unique () {
+    if (nrows == 0)
+      return;
+    size_t last = 0;
+    for (size_t i = 1; i < nrows; ++i)
+      if (! bits_equal(row(last), row(i), stride)) {
+	++last;
+	if (last != i)
+	  copy(row(i), row(i) + stride, row(last));
+      }
+    nrows = last + 1;
+    words.resize(nrows * stride);
+  }
+};
+
+// immutable view into a packed matrix: behaves as if only the columns set
+// in the mask were present; hiding a column flips one bit of the mask
+class MatrixMask {
+private:
+  const BitMatrix *matrix;
+  const BitMatrix *index;	// column index of the matrix, if any
+  Words cols;			// packed column mask
+  size_t ncols;			// number of visible columns
+
+public:
+  explicit MatrixMask (const BitMatrix &M, const BitMatrix *C = nullptr)
+    : matrix(&M), index(C), cols(M.row_stride()), ncols(M.num_cols()) {
+    bits_ones(cols.data(), ncols);
+  }
+
+  inline bool visible (const size_t j) const {
+    return (cols[j / WORDBITS] >> (j % WORDBITS)) & 1;
+  }
+  // hides a column without erasing it from the original matrix
+  inline void hide_column (const size_t j) {
+    if (visible(j)) {
+      cols[j / WORDBITS] &= ~(Word(1) << (j % WORDBITS));
+      --ncols;
+    }
+  }
+  inline void show_column (const size_t j) {
+    if (! visible(j)) {
+      cols[j / WORDBITS] |= Word(1) << (j % WORDBITS);
+      ++ncols;
+    }
+  }
+
+  inline bool empty () const { return matrix->empty(); }
+  inline size_t num_rows () const { return matrix->size(); }
+  inline size_t num_cols () const { return ncols; }
+  inline size_t row_stride () const { return matrix->row_stride(); }
+  inline const Word* mask () const { return cols.data(); }
+  // the words of row i including the hidden columns, apply mask() to them
+  inline const Word* row (const size_t i) const { return matrix->row(i); }
+  inline RowView operator[] (const size_t i) const { return (*matrix)[i]; }
+  inline const BitMatrix* column_index () const { return index; }
+};
+
+//==============================================================================
@@ -0,0 +1,248 @@
+/**************************************************************************
+ *                                                                        *
+ *                                                                        *
+ *	         Multiple Classification Project (MCP)                    *
+ *                                                                        *
+ *	Author:   Miki Hermann                                            *
+ *	e-mail:   hermann@lix.polytechnique.fr                            *
+ *	Address:  LIX (CNRS UMR 7161), Ecole Polytechnique, France        *
+ *                                                                        *
+ *	Author: Gernot Salzer                                             *
+ *	e-mail: gernot.salzer@tuwien.ac.at                                *
+ *	Address: Technische Universitaet Wien, Vienna, Austria            *
+ *                                                                        *
+ *	Version: all                                                      *
+ *      File:    mcp-bits.hpp                                             *
+ *                                                                        *
+ *      Copyright (c) 2019 - 2025                                         *
+ *                                                                        *
+ * Word-wide kernels (subset, meet, popcount, Hamming distance) on bits   *
+ * packed into contiguous 64-bit words, shared by the packed rows and the *
+ * packed matrices.                                                       *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <new>
+#if __cplusplus >= 202002L
+#include <bit>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+typedef uint64_t Word;
+const size_t WORDBITS = 64;
+
+inline size_t num_words (const size_t nbits) {
+  return (nbits + WORDBITS - 1) / WORDBITS;
+}
+
+inline size_t popcount64 (const Word w) {
+#if __cplusplus >= 202002L
+  return std::popcount(w);
+#else
+  return __builtin_popcountll(w);
+#endif
+}
+
+inline size_t ctz64 (const Word w) {
+#if __cplusplus >= 202002L
+  return std::countr_zero(w);
+#else
+  return __builtin_ctzll(w);
+#endif
+}
+
+//------------------------------------------------------------------------------
+// word kernels; nw is the number of words, unused bits must be 0
+
+// sets the first nbits bits, the unused bits of the last word remain 0
+inline void bits_ones (Word *a, const size_t nbits) {
+  const size_t nw = num_words(nbits);
+  for (size_t w = 0; w < nw; ++w)
+    a[w] = ~Word(0);
+  if (nbits % WORDBITS != 0)
+    a[nw-1] = (Word(1) << (nbits % WORDBITS)) - 1;
+}
+
+inline bool bits_any (const Word *a, const size_t nw) {
+  for (size_t w = 0; w < nw; ++w)
+    if (a[w] != 0)
+      return true;
+  return false;
+}
+
+// is a >= b coordinate wise, i.e., is b a subset of a?
+inline bool bits_geq (const Word *a, const Word *b, const size_t nw) {
+  size_t w = 0;
+#ifdef __AVX2__
+  for (; w + 4 <= nw; w += 4) {
+    const __m256i va = _mm256_loadu_si256((const __m256i *) (a + w));
+    const __m256i vb = _mm256_loadu_si256((const __m256i *) (b + w));
+    if (! _mm256_testc_si256(va, vb))	// (~a & b) != 0
+      return false;
+  }
+#endif
+  for (; w < nw; ++w)
+    if (b[w] & ~a[w])
+      return false;
+  return true;
+}
+
+// is a & b nonzero, i.e., do a and b share a 1?
+inline bool bits_intersect (const Word *a, const Word *b, const size_t nw) {
+  size_t w = 0;
+#ifdef __AVX2__
+  for (; w + 4 <= nw; w += 4) {
+    const __m256i va = _mm256_loadu_si256((const __m256i *) (a + w));
+    const __m256i vb = _mm256_loadu_si256((const __m256i *) (b + w));
+    if (! _mm256_testz_si256(va, vb))	// (a & b) != 0
+      return true;
+  }
+#endif
+  for (; w < nw; ++w)
+    if (a[w] & b[w])
+      return true;
+  return false;
+}
+
+// c = a & b (meet); c may alias a or b
+inline void bits_and (Word *c, const Word *a, const Word *b, const size_t nw) {
+  size_t w = 0;
+#ifdef __AVX2__
+  for (; w + 4 <= nw; w += 4) {
+    const __m256i va = _mm256_loadu_si256((const __m256i *) (a + w));
+    const __m256i vb = _mm256_loadu_si256((const __m256i *) (b + w));
+    _mm256_storeu_si256((__m256i *) (c + w), _mm256_and_si256(va, vb));
+  }
+#endif
+  for (; w < nw; ++w)
+    c[w] = a[w] & b[w];
+}
+
+// number of bits set
+inline size_t bits_count (const Word *a, const size_t nw) {
+  size_t sum = 0;
+  for (size_t w = 0; w < nw; ++w)
+    sum += popcount64(a[w]);
+  return sum;
+}
+
+// number of bits set in a & b
+inline size_t bits_count_and (const Word *a, const Word *b, const size_t nw) {
+  size_t sum = 0;
+  for (size_t w = 0; w < nw; ++w)
+    sum += popcount64(a[w] & b[w]);
+  return sum;
+}
+
+// number of coordinates where a and b differ
+inline size_t bits_hamming (const Word *a, const Word *b, const size_t nw) {
+  size_t sum = 0;
+  for (size_t w = 0; w < nw; ++w)
+    sum += popcount64(a[w] ^ b[w]);
+  return sum;
+}
+
+// is (a & pos) | (~a & neg) nonzero?
+// with pos and neg the masks of positive and negative literals of a clause
+inline bool bits_sat (const Word *a, const Word *pos, const Word *neg,
+		      const size_t nw) {
+  for (size_t w = 0; w < nw; ++w)
+    if ((a[w] & pos[w]) | (~a[w] & neg[w]))
+      return true;
+  return false;
+}
+
+// lexicographic order with bit 0 as the most significant position
+inline bool bits_less (const Word *a, const Word *b, const size_t nw) {
+  for (size_t w = 0; w < nw; ++w) {
+    const Word diff = a[w] ^ b[w];
+    if (diff != 0)
+      return (b[w] & diff & (~diff + 1)) != 0;
+  }
+  return false;
+}
+
+inline bool bits_equal (const Word *a, const Word *b, const size_t nw) {
+  for (size_t w = 0; w < nw; ++w)
+    if (a[w] != b[w])
+      return false;
+  return true;
+}
+
+// are a and b equal on the bits set in mask?
+inline bool bits_equal (const Word *a, const Word *b, const Word *mask,
+			const size_t nw) {
+  for (size_t w = 0; w < nw; ++w)
+    if ((a[w] ^ b[w]) & mask[w])
+      return false;
+  return true;
+}
+
+// copies len bits of a starting at bit from to b starting at bit to;
+// the bits of b must be 0 there, they are or-ed in up to a word at a time
+inline void bits_copy (Word *b, size_t to, const Word *a, size_t from, size_t len) {
+  while (len > 0) {
+    const size_t chunk = min(len, WORDBITS - from % WORDBITS);
+    Word x = a[from / WORDBITS] >> (from % WORDBITS);
+    if (chunk < WORDBITS)
+      x &= (Word(1) << chunk) - 1;
+    b[to / WORDBITS] |= x << (to % WORDBITS);
+    if (to % WORDBITS + chunk > WORDBITS)
+      b[to / WORDBITS + 1] |= x >> (WORDBITS - to % WORDBITS);
+    from += chunk;
+    to += chunk;
+    len -= chunk;
+  }
+}
+
+// hash of the bits of a set in mask
+inline size_t bits_hash (const Word *a, const Word *mask, const size_t nw) {
+  Word h = 0;
+  for (size_t w = 0; w < nw; ++w) {
+    const Word x = (a[w] & mask[w]) * 0x9e3779b97f4a7c15ULL;
+    h = (h ^ x ^ (x >> 29)) * 0xbf58476d1ce4e5b9ULL;
+  }
+  return h;
+}
+
+//------------------------------------------------------------------------------
+// allocator handing out cache line aligned word buffers
+
+const size_t CACHELINE = 64;
+
+template <typename T>
+struct AlignedAllocator {
+  typedef T value_type;
+
+  AlignedAllocator () = default;
+  template <typename U>
+  AlignedAllocator (const AlignedAllocator<U> &) {}
+
+  T* allocate (const size_t n) {
+    return static_cast<T*>(::operator new(n * sizeof(T), align_val_t(CACHELINE)));
+  }
+  void deallocate (T *p, const size_t) {
+    ::operator delete(p, align_val_t(CACHELINE));
+  }
+
+  template <typename U>
+  bool operator== (const AlignedAllocator<U> &) const { return true; }
+  template <typename U>
+  bool operator!= (const AlignedAllocator<U> &) const { return false; }
+};
+
+typedef vector<Word, AlignedAllocator<Word>> Words;
+
+//==============================================================================
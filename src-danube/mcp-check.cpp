@@ -265,7 +265,7 @@ void read_matrix (Group_of_Matrix &matrix) {
     if (arity != temp.size())
       cout << "*** arity discrepancy on line " << numline << endl;
 
-    matrix[group].push_back(temp);
+    push_back(matrix[group], temp);
   }
   
   if (input != STDIN)
@@ -286,7 +286,7 @@ void print_matrix (const Group_of_Matrix &matrix) {
   for (auto group = matrix.cbegin(); group != matrix.cend(); ++group) {
     cout << "+++ Group " << group->first;
     grps.push_back(group->first);
-    Matrix gmtx = group->second;
+    const BitMatrix &gmtx = group->second;
     cout << " [" << gmtx.size() << "]:" << endl;
     if (display == yPEEK || display == ySHOW)
       cout << gmtx << endl;
@@ -311,8 +311,8 @@ void print_formula (const vector<size_t> &names, const Formula &formula) {
 
 void sat_test (const Group_of_Matrix &matrix, const Formula &formula) {
   for (auto group = matrix.begin(); group != matrix.end(); ++group) {
-    Matrix gmtx = group->second;
-    for (Row row : gmtx)
+    const Matrix gmtx = unpack(group->second);
+    for (const Row &row : gmtx)
       if (group->first == suffix) {		
 	// must satisfy
 	if (sat_formula(row, formula))
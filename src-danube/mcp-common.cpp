@@ -31,6 +31,9 @@
 #include <sstream>
 #include <random>
 #include <memory>
+#include <functional>
+#include <queue>
+#include <numeric>
 #include "mcp-matrix+formula.hpp"
 #include "mcp-common.hpp"
 #include <string>
@@ -60,11 +63,13 @@ string input        = STDIN;
 string output       = STDOUT;
 string headerput    = "";
 string weights      = "";
-bool disjoint       = true;
+thread_local bool disjoint = true;
 int cluster         = SENTINEL;
 string tpath        = "/tmp/";		// directory where the temporary files will be stored
 bool np_fit	    = false;
 unsigned chunkLIMIT      = 4096;	// heavily hardware dependent; must be optimized
+unsigned nthreads        = 0;		// size of the thread pool, 0 = all hardware threads
+unsigned bufferLIMIT     = 1024;	// MB of output kept in memory by mcp-pthread
 string latex        = "";		// file to store latex output
 
 ifstream infile;
@@ -80,7 +85,8 @@ const string action_strg[]    = {"One to One", "One to All Others",
 const string closure_strg[]   = {"", "Horn",       "dual Horn",  "bijunctive", "affine", "CNF"};
 const string cooking_strg[]   = {"", "raw",        "bleu",       "medium",     "well done"};
 const string direction_strg[] = {"", "begin",      "end",        "optimum",    "random",
-				 "low cardinality", "high cardinality", "precedence"};
+				 "low cardinality", "high cardinality", "precedence",
+				 "block"};
 const string pcl_strg[]       = {"Horn",       "Horn",       "bijunctive", "affine", "cnf"};
 const string strategy_strg[]  = {"large",      "exact"};
 const string arch_strg[]      = {"seq",        "mpi",        "pthread",    "hybrid"};
@@ -129,6 +135,9 @@ const unordered_map<string, Parameter> param_values = {
   {"--shift", parOFFSET},
   {"--sh", parOFFSET},
   {"--chunk", parCHUNK},
+  {"--th", parTHREADS},
+  {"--threads", parTHREADS},
+  {"--buffer", parBUFFER},
   {"--debug", parDEBUG}
 };
 
@@ -227,6 +236,8 @@ void read_arg (int argc, char *argv[]) {	// reads the input parameters
 	  direction = dRAND;
 	} else if (dir == "precedence" || dir == "prec") {
 	  direction = dPREC;
+	} else if (dir == "block" || dir == "group") {
+	  direction = dBLOCK;
 	} else 
 	  cerr << "+++ unknown direction option " << dir << endl;
       } else
@@ -351,6 +362,30 @@ void read_arg (int argc, char *argv[]) {	// reads the input parameters
       } else
 	cerr << "+++ no chunk limit selected, revert to default" << endl;
       break;
+    case parTHREADS:
+      if (argument + 1 < size_t(argc)) {
+	try {
+	  nthreads = stoul(argv[++argument]);
+	} catch (const invalid_argument &) {
+	  cerr << "+++ " << argv[argument]
+	       << " is not a valid number of threads, revert to default"
+	       << endl;
+	}
+      } else
+	cerr << "+++ no number of threads selected, revert to default" << endl;
+      break;
+    case parBUFFER:
+      if (argument + 1 < size_t(argc)) {
+	try {
+	  bufferLIMIT = stoul(argv[++argument]);
+	} catch (const invalid_argument &) {
+	  cerr << "+++ " << argv[argument]
+	       << " is not a valid buffer limit, revert to default"
+	       << endl;
+	}
+      } else
+	cerr << "+++ no buffer limit selected, revert to default" << endl;
+      break;
     case parDEBUG:
       debug = true;
       break;
@@ -448,22 +483,45 @@ Row MIN (const Matrix &M) {
   return m;
 }
 
-bool InHornClosure (const Row &row, const Matrix &M) {
-  // is the tuple row in the Horn closure of matrix M?
-  unique_ptr<Row> P = ObsGeq(row, M);
+bool InHornClosure (const RowView &row, const MatrixMask &T) {
+  // is the tuple row in the Horn closure of T, on the visible columns?
+  unique_ptr<Row> P = ObsGeq(row, T);
   if (P == nullptr)
     return false;
-  else
-    return row == *P;
+  for (size_t j = 0; j < row.size(); ++j)
+    if (T.visible(j) && (*P)[j] != row[j])
+      return false;
+  return true;
 }
 
-bool SHCPsolvable (const Matrix &T, const Matrix &F) {
+bool HornClause (const RowView &f, const MatrixMask &T, Clause &clause) {
+  // the Horn clause eliminating f, read off the minimum of the rows of T
+  // above f: the negated ones of f and as head the first visible column
+  // where the minimum is 1 and f is 0, no head if no row is above f;
+  // false if there is no such column, i.e., f is in the Horn closure of T
+  clause.assign(f.size(), lnone);
+  for (size_t j = 0; j < f.size(); ++j)
+    if (f[j])
+      clause[j] = lneg;
+  unique_ptr<Row> P = ObsGeq(f, T);
+  if (P == nullptr)
+    return true;
+  for (size_t j = 0; j < f.size(); ++j)
+    if (T.visible(j) && (*P)[j] && ! f[j]) {
+      clause[j] = lpos;
+      return true;
+    }
+  return false;
+}
+
+bool SHCPsolvable (const MatrixMask &T, const MatrixMask &F) {
   // is the intersection of F and of the Horn closure of T empty?
-  // T = MinimizeObs(T);	// Optional, may not be worth the effort
-  for (const Row &f : F) 
-    if (InHornClosure (f, T))
-      return false;
-  return true;
+  // T must carry its column index, which is queried for every f in F;
+  // the callers reduce T to its meet-irreducible rows (meet_irreducible)
+  if (T.empty())
+    return true;
+  return ! parallel_any(F.num_rows(),
+			[&] (const size_t i) { return InHornClosure(F[i], T); });
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -486,26 +544,163 @@ Row Majority (const Row &a, const Row &b, const Row &c) {
   return maj;
 }
 
-bool isect_nonempty (const Matrix &T, const Matrix &F) {
-  // is the intersection of T and F nonempty?
-  unordered_set<Row> orig;
-
-  orig.insert(T.cbegin(), T.cend());
-  for (const Row &row : F)
-    if (orig.find(row) != orig.end())
-      return true;
-  return false;
+bool isect_nonempty (const MatrixMask &T, const MatrixMask &F) {
+  // is the intersection of T and F nonempty, on the visible columns?
+  // the rows are hashed and compared through the mask, without copying;
+  // indices below |T| denote rows of T, the others rows of F
+  const size_t Tsize = T.num_rows();
+  const size_t nw = T.row_stride();
+  const Word *mask = T.mask();
+  auto words = [&] (const size_t i) {
+    return i < Tsize ? T.row(i) : F.row(i - Tsize);
+  };
+  auto hash = [&] (const size_t i) {
+    return bits_hash(words(i), mask, nw);
+  };
+  auto equal = [&] (const size_t i, const size_t j) {
+    return bits_equal(words(i), words(j), mask, nw);
+  };
+  unordered_set<size_t, decltype(hash), decltype(equal)> orig(Tsize, hash, equal);
+
+  for (size_t i = 0; i < Tsize; ++i)
+    orig.insert(i);
+  return parallel_any(F.num_rows(),
+		      [&] (const size_t i) { return orig.find(Tsize + i) != orig.end(); },
+		      1024);
 }
 
-bool inadmissible (const Matrix &T, const Matrix &F) {
+bool inadmissible (const MatrixMask &T, const MatrixMask &F) {
   if (closure < clBIJUNCTIVE)
     return ! SHCPsolvable(T,F);
   else
     return isect_nonempty(T,F);
 }
 
+bool inadmissible (const Matrix &T, const Matrix &F) {
+  const size_t lngt = T.empty() ? 0 : T[0].size();
+  const BitMatrix Tp = pack(T, lngt);
+  const BitMatrix Fp = pack(F, lngt);
+  const BitMatrix Tc = closure < clBIJUNCTIVE ? Tp.transpose() : BitMatrix();
+  return inadmissible(MatrixMask(Tp, &Tc), MatrixMask(Fp));
+}
+
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
+// Incremental Horn admissibility of T and F while columns are hidden.
+// For every f in F it keeps the minimum of the rows of T above f on the
+// visible columns (see ObsGeq) and a witness: a visible column where
+// this minimum is 1 and f is 0, so that f is not in the Horn closure of T.
+// Hiding a column c where f is 0 does not change the rows above f, so f
+// needs a new witness only if its witness was c, and the cached minimum
+// provides it without looking at T.  Only the f with a 1 in c gain rows
+// above them and are recomputed from the column index of T.
+class HornSeparation {
+private:
+  static const size_t NOWITNESS = SIZE_MAX;	// f is in the Horn closure
+  static const size_t NOABOVE = SIZE_MAX - 1;	// no row of T is above f
+
+  const BitMatrix &C;		// column index of T
+  const BitMatrix &F;
+  MatrixMask mask;		// visible columns
+  BitMatrix meets;		// minimum of the rows above f, for every f
+  vector<size_t> witness;
+
+  // a visible column where the minimum m of f is 1 and f is 0
+  size_t find_witness (const size_t i, const Word *m) const {
+    const Word *f = F.row(i);
+    const Word *visible = mask.mask();
+    for (size_t w = 0; w < F.row_stride(); ++w) {
+      const Word bits = m[w] & ~f[w] & visible[w];
+      if (bits != 0)
+	return w * WORDBITS + ctz64(bits);
+    }
+    return NOWITNESS;
+  }
+
+  // computes the minimum m and the witness of f from scratch;
+  // several f may be separated at the same time
+  size_t separate (const size_t i, Word *m) const {
+    const size_t nw = C.row_stride();
+    const Word *f = F.row(i);
+    const Word *visible = mask.mask();
+    thread_local vector<Word> above;
+    above.resize(nw);
+    bits_ones(above.data(), C.num_cols());
+    for (size_t w = 0; w < F.row_stride(); ++w)
+      for (Word bits = f[w] & visible[w]; bits != 0; bits &= bits - 1)
+	bits_and(above.data(), above.data(), C.row(w * WORDBITS + ctz64(bits)), nw);
+    if (! bits_any(above.data(), nw))
+      return NOABOVE;
+
+    fill(m, m + meets.row_stride(), 0);
+    for (size_t w = 0; w < F.row_stride(); ++w) {
+      m[w] = f[w] & visible[w];
+      for (Word bits = ~f[w] & visible[w]; bits != 0; bits &= bits - 1) {
+	const size_t j = w * WORDBITS + ctz64(bits);
+	if (bits_geq(C.row(j), above.data(), nw))
+	  m[w] |= Word(1) << (j % WORDBITS);
+      }
+    }
+    return find_witness(i, m);
+  }
+
+public:
+  // T and F must have the same columns, Tc is the column index of T
+  HornSeparation (const BitMatrix &T, const BitMatrix &Tc, const BitMatrix &F)
+    : C(Tc), F(F), mask(T, &Tc), meets(T.num_cols()), witness(F.size()) {
+    for (size_t i = 0; i < F.size(); ++i)
+      meets.append();
+    parallel_for(F.size(),
+		 [this] (const size_t i) { witness[i] = separate(i, meets.row(i)); },
+		 16);
+  }
+
+  // is every f separated from the Horn closure of T?
+  bool admissible () const {
+    return find(witness.cbegin(), witness.cend(), NOWITNESS) == witness.cend();
+  }
+
+  // hides the column c if T and F remain admissible without it;
+  // the new minima and witnesses are computed aside, and are committed
+  // only if no f falls into the Horn closure; otherwise c is shown again
+  bool hide_column (const size_t c) {
+    vector<size_t> touched;		// the f with a 1 in c or witnessed by c
+    for (size_t i = 0; i < F.size(); ++i)
+      if (F.get(i, c) || witness[i] == c)
+	touched.push_back(i);
+
+    mask.hide_column(c);
+    BitMatrix fresh(meets.num_cols());
+    fresh.reserve(touched.size());
+    for (size_t k = 0; k < touched.size(); ++k)
+      fresh.append();
+    vector<size_t> found(touched.size());
+    const bool lost =
+      parallel_any(touched.size(),
+		   [&] (const size_t k) {
+		     const size_t i = touched[k];
+		     found[k] = F.get(i, c)
+		       ? separate(i, fresh.row(k))
+		       : find_witness(i, meets.row(i));
+		     return found[k] == NOWITNESS;
+		   },
+		   16);
+    if (lost) {
+      mask.show_column(c);
+      return false;
+    }
+
+    const size_t stride = meets.row_stride();
+    for (size_t k = 0; k < touched.size(); ++k) {
+      const size_t i = touched[k];
+      witness[i] = found[k];
+      if (F.get(i, c))
+	copy(fresh.row(k), fresh.row(k) + stride, meets.row(i));
+    }
+    return true;
+  }
+};
+
 Matrix section (const Row &alpha, const Matrix &A) {
   // section of matrix A to columns determined by bitvector alpha
   Matrix B;
@@ -526,110 +721,133 @@ size_t hamming_weight (const Row &row) {
   return row.count();
 }
 
-Matrix join (const Matrix &head, const Matrix &tail) {
-  // join two matrices: join rows
-  if (tail.empty())
-    return head;
-  if (head.empty())
-    return tail;
-
-  Matrix join;  
-  for (size_t i = 0; i < head.size(); ++i) {
-    Row row = head[i];
-    // auto row_it = back_inserter(row);
-    // copy(tail[i].begin(), tail[i].end(), row_it);
-    for (size_t j = 0; j < tail[i].size(); ++j)
-      row.push_back(tail[i][j]);
-    join.push_back(row);
+// we search for coordinate with unequal values in T and F
+// or both T and F have all Boolean values on that coordinate
+static inline void keep_one (const Matrix &T, const Matrix &F,
+			     const vector<size_t> &coords, Row &A) {
+  for (size_t j = 0; j < coords.size(); ++j) {
+    unordered_set<bool> Tval, Fval;
+    for (const Row &t : T)
+      Tval.insert(t[coords[j]]);
+    for (const Row &f : F)
+      Fval.insert(f[coords[j]]);
+    if (Fval != Tval || Fval.size() == 2 && Tval.size() == 2) {
+      A[coords[j]] = true;
+      return;
+    }
   }
-  return join;
 }
 
+// Tp, Tc and Fp are T, its column index and F packed (see minsect)
 static inline Row eliminate (const Matrix &T, const Matrix &F,
-			     const vector<size_t> &coords) {
+			     const BitMatrix &Tp, const BitMatrix &Tc,
+			     const BitMatrix &Fp, const vector<size_t> &coords) {
   const size_t lngt  = T[0].size();
-  const size_t Tsize = T.size();
-  const size_t Fsize = F.size();
+
+  // each candidate section is only a column mask;
+  // for Horn closures the witnesses separating F from T are kept across
+  // the coordinates, otherwise inadmissible is evaluated on the masks
+  MatrixMask Tm(Tp, &Tc), Fm(Fp);
+  unique_ptr<HornSeparation> hs;
+  if (closure < clBIJUNCTIVE)
+    hs = make_unique<HornSeparation>(Tp, Tc, Fp);
 
   Row A(lngt, true);
-  Matrix Thead, Fhead, Ttail, Ftail;
-  
-  for (const Row &t : T) {
-    Row row(lngt);
-    for (size_t j = 0; j < lngt; ++j)
-      // row.push_back(t[coords[j]]);
-      row[j] = t[coords[j]];
-    Ttail.push_back(row);
-  }
-  for (const Row &f : F) {
-    Row row(lngt);
-    for (size_t j = 0; j < lngt; ++j)
-      // row.push_back(f[coords[j]]);
-      row[j] = f[coords[j]];
-    Ftail.push_back(row);
-  }
-  
   for (size_t i = 0; i < lngt; ++i) {
     A[coords[i]] = false;
-    Row Tcolumn, Fcolumn;
-    // if (!Ttail.empty())
-    for (size_t j = 0; j < Tsize; ++j) {
-      Tcolumn.push_back(front(Ttail[j]));
-      pop_front(Ttail[j]);
-    }
-    // if (!Ftail.empty())
-    for (size_t j = 0; j < Fsize; ++j) {
-      Fcolumn.push_back(front(Ftail[j]));
-      pop_front(Ftail[j]);
-    }
-    Matrix Ta = join(Thead, Ttail);
-    Matrix Fa = join(Fhead, Ftail);
-    if (inadmissible(Ta,Fa)) {
-      A[coords[i]] = true;
-      if (Thead.empty())
-	for (size_t j = 0; j < Tsize; ++j) {
-	  Row row(1, Tcolumn[j]);
-	  // row.push_back(Tcolumn[j]);
-	  Thead.push_back(row);
-	}
-      else
-	for (size_t j = 0; j < Tsize; ++j)
-	  Thead[j].push_back(Tcolumn[j]);
-      if (Fhead.empty())
-	for (size_t j = 0; j < Fsize; ++j) {
-	  Row row(1, Fcolumn[j]);
-	  // row.push_back(Fcolumn[j]);
-	  Fhead.push_back(row);
-	}
-      else
-	for (size_t j = 0; j < Fsize; ++j)
-	  Fhead[j].push_back(Fcolumn[j]);
+    if (hs != nullptr) {
+      if (! hs->hide_column(coords[i]))
+	A[coords[i]] = true;
+    } else {
+      Tm.hide_column(coords[i]);
+      Fm.hide_column(coords[i]);
+      if (inadmissible(Tm,Fm)) {
+	A[coords[i]] = true;
+	Tm.show_column(coords[i]);
+	Fm.show_column(coords[i]);
+      }
     }
     // we must keep at least one coordinate
     if (hamming_weight(A) == 0) {
-      // we search for coordinate with unequal values in T and F
-      // or both T and F have all Boolean values on that coordinate
-      for (size_t j = 0; j < coords.size(); ++j) {
-	unordered_set<bool> Tval, Fval;
-	for (size_t k = 0; k < Tsize; ++k)
-	  Tval.insert(T[k][coords[j]]);
-	for (size_t k = 0; k < Fsize; ++k)
-	  Fval.insert(F[k][coords[j]]);
-	if (Fval != Tval || Fval.size() == 2 && Tval.size() == 2) {
-	  A[coords[j]] = true;
-	  return A;
-	}
-      }
+      keep_one(T, F, coords, A);
+      return A;
     }
   }
   return A;
 }
 
+// adds to B a minimal subset X of the coordinates C[0..n-1] such that T
+// and F are admissible on B+X, preferring the first coordinates of C
+// (QuickXplain): the second half of C is reduced while the first half is
+// kept, then the first half while the reduced second half is kept;
+// delta tells whether B is worth testing on its own
+static void quickxplain (const function<bool (const Row &)> &admissible,
+			 Row &B, const bool delta,
+			 const size_t *C, const size_t n) {
+  if (delta && admissible(B))
+    return;
+  if (n == 0)
+    return;
+  if (n == 1) {
+    B[C[0]] = true;
+    return;
+  }
+  const size_t k = n / 2;
+  Row B2 = B;
+  for (size_t i = 0; i < k; ++i)
+    B2[C[i]] = true;
+  quickxplain(admissible, B2, true, C + k, n - k);
+  bool reduced = false;		// is X2 = B2 restricted to C[k..n-1] nonempty?
+  for (size_t i = k; i < n; ++i)
+    if (B2[C[i]]) {
+      B[C[i]] = true;
+      reduced = true;
+    }
+  quickxplain(admissible, B, reduced, C, k);
+}
+
+// group testing version of eliminate: drops whole blocks of coordinates
+// at once and bisects only the blocks that cannot be dropped, which needs
+// about k.log(n) admissibility tests for a section of k coordinates
+static inline Row eliminate_blocks (const Matrix &T, const Matrix &F,
+				    const BitMatrix &Tp, const BitMatrix &Tc,
+				    const BitMatrix &Fp, const vector<size_t> &coords) {
+  const size_t lngt = T[0].size();
+
+  // are T and F admissible on the coordinates set in A?
+  auto admissible = [&] (const Row &A) {
+    MatrixMask Tm(Tp, &Tc), Fm(Fp);
+    for (size_t j = 0; j < lngt; ++j)
+      if (! A[j]) {
+	Tm.hide_column(j);
+	Fm.hide_column(j);
+      }
+    return ! inadmissible(Tm, Fm);
+  };
+
+  // the coordinates eliminate would try to remove last are preferred
+  const vector<size_t> keep(coords.crbegin(), coords.crend());
+  Row A(lngt, false);
+  quickxplain(admissible, A, true, keep.data(), keep.size());
+  // we must keep at least one coordinate
+  if (hamming_weight(A) == 0)
+    keep_one(T, F, coords, A);
+  return A;
+}
+
 // computes the minimal section
 Row minsect (const Matrix &T, const Matrix &F) {
   const size_t lngt  = T[0].size();
 
-  if (inadmissible(T,F)) {
+  // T and F are packed once for all admissibility tests; for Horn closures
+  // the meet-irreducible rows of T have the same closure on every section
+  const BitMatrix Tp = closure < clBIJUNCTIVE
+    ? meet_irreducible(pack(T, lngt))
+    : pack(T, lngt);
+  const BitMatrix Fp = pack(F, lngt);
+  const BitMatrix Tc = closure < clBIJUNCTIVE ? Tp.transpose() : BitMatrix();
+
+  if (inadmissible(MatrixMask(Tp, &Tc), MatrixMask(Fp))) {
     disjoint = false;
     const Row emptyrow(lngt, false);
     return emptyrow;
@@ -642,6 +860,7 @@ Row minsect (const Matrix &T, const Matrix &F) {
 
   switch (direction) {
   case dBEGIN:
+  case dBLOCK:
     for (size_t i = 0; i < lngt; ++i)
       coord[i] = lngt - 1 - i;
     break;
@@ -735,7 +954,9 @@ Row minsect (const Matrix &T, const Matrix &F) {
     cout << endl;
   } break;
   }
-  return eliminate(T, F, coord);
+  if (direction == dBLOCK)
+    return eliminate_blocks(T, F, Tp, Tc, Fp, coord);
+  return eliminate(T, F, Tp, Tc, Fp, coord);
 }
 
 void w_f (const string &filename, const string suffix,
@@ -796,6 +1017,101 @@ bool satisfied_by (const Clause &clause, const Matrix &T) {
   return true;
 }
 
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// Emptiness of the four quadrants of every pair of columns of a matrix M.
+// Row 2j+a of the bitmaps holds the rows of M with value a in column j, so
+// that no row has a in column j1 and b in column j2 iff the bitmaps of
+// (j1, a) and (j2, b) are disjoint.  On the diagonal (j, a) against (j, a)
+// tells whether column j is constant.  The pairs are swept in tiles of
+// columns whose bitmaps fit together into the cache, one task per tile.
+class PairQuadrants {
+private:
+  static const size_t TILEBYTES = 1 << 17;	// bitmaps of a tile, about half an L2
+
+  size_t n;
+  vector<unsigned char> empty;	// bit 2a+b for the pair (j1, j2), j1 <= j2
+
+public:
+  PairQuadrants (const Matrix &M, const size_t ncols)
+    : n(ncols), empty(ncols * ncols, 0) {
+    const BitMatrix C = pack(M, ncols).transpose();
+    BitMatrix bitmaps(M.size());
+    bitmaps.reserve(2 * n);
+    for (size_t j = 0; j < n; ++j) {
+      Word *zeros = bitmaps.append();
+      bits_ones(zeros, M.size());
+      for (size_t w = 0; w < C.row_stride(); ++w)
+	zeros[w] &= ~C.row(j)[w];
+      bitmaps.append(C.row(j));
+    }
+
+    const size_t stride = bitmaps.row_stride();
+    const size_t width = max<size_t>(1, TILEBYTES / (4 * sizeof(Word) * max<size_t>(stride, 1)));
+    const size_t ntiles = (n + width - 1) / width;
+    vector<pair<size_t, size_t>> tiles;
+    for (size_t b1 = 0; b1 < ntiles; ++b1)
+      for (size_t b2 = b1; b2 < ntiles; ++b2)
+	tiles.emplace_back(b1, b2);
+
+    parallel_for(tiles.size(),
+		 [&] (const size_t k) {
+		   const size_t end1 = min(n, (tiles[k].first + 1) * width);
+		   const size_t end2 = min(n, (tiles[k].second + 1) * width);
+		   for (size_t j1 = tiles[k].first * width; j1 < end1; ++j1)
+		     for (size_t j2 = max(j1, tiles[k].second * width); j2 < end2; ++j2) {
+		       unsigned char e = 0;
+		       for (size_t a = 0; a < 2; ++a)
+			 for (size_t b = 0; b < 2; ++b)
+			   if (! bits_intersect(bitmaps.row(2*j1 + a), bitmaps.row(2*j2 + b), stride))
+			     e |= 1 << (2*a + b);
+		       empty[j1 * n + j2] = e;
+		     }
+		 });
+  }
+
+  // does no row have the value a in column j1 and b in column j2?  j1 <= j2
+  inline bool none (const size_t j1, const bool a, const size_t j2, const bool b) const {
+    return (empty[j1 * n + j2] >> (2*a + b)) & 1;
+  }
+};
+
+Formula bijunctive_clauses (const Matrix &T, const Matrix *F) {
+  // the clauses of one or two literals satisfied by all tuples in T,
+  // and, if F is given, falsified by some tuple in F;
+  // a literal is falsified by the value 0 if positive, 1 if negative
+  const size_t lngt = T[0].size();
+  const Literal literals[] = {lpos, lneg};
+  const PairQuadrants QT(T, lngt);
+  const unique_ptr<PairQuadrants> QF
+    = F == nullptr ? nullptr : make_unique<PairQuadrants>(*F, lngt);
+  auto holds = [&] (const size_t j1, const Literal lit1, const size_t j2, const Literal lit2) {
+    return QT.none(j1, lit1 == lneg, j2, lit2 == lneg)
+      && (QF == nullptr || ! QF->none(j1, lit1 == lneg, j2, lit2 == lneg));
+  };
+
+  Formula B;
+  for (size_t j = 0; j < lngt; ++j)
+    for (const Literal lit : literals)
+      if (holds(j, lit, j, lit)) {
+	Clause clause(lngt, lnone);
+	clause[j] = lit;
+	B.push_back(clause);
+      }
+
+  for (size_t j1 = 0; j1 + 1 < lngt; ++j1)
+    for (size_t j2 = j1+1; j2 < lngt; ++j2)
+      for (const Literal lit1 : literals)
+	for (const Literal lit2 : literals)
+	  if (holds(j1, lit1, j2, lit2)) {
+	    Clause clause(lngt, lnone);
+	    clause[j1] = lit1;
+	    clause[j2] = lit2;
+	    B.push_back(clause);
+	  }
+  return B;
+}
+
 size_t numlit (const Clause &clause) {
   // number of literals in a clause
   size_t i = 0;
@@ -865,39 +1181,147 @@ bool operator>= (const Clause &a, const Clause &b) {
 //   }
 // };
 
-// partition matrix or formula
-template <typename U, template<typename> typename T>
-int partition_mf (T<U> &t, int low, int high)
-{
-  U pivot = t[high];
-  int p_index = low;
-    
-  for (int i = low; i < high; i++)
-    if (t[i] <= pivot)
-      swap(t[i], t[p_index++]);
-  swap(t[high], t[p_index]);
-    
-  return p_index;
-}
-
 // sort matrix or formula
+// introsort: neither sorted input nor many equal elements make it quadratic
 template <typename T>
 void sort_mf (T &t, int low, int high) {
-  if (low < high) {
-    int p_index = partition_mf(t, low, high);
-    sort_mf(t, low, p_index-1);
-    sort_mf(t, p_index+1, high);
+  if (low < high)
+    sort(t.begin() + low, t.begin() + high + 1);
+}
+
+// byte k of a row in the order of Row: the last column is the most
+// significant bit, so the bytes are taken from the last one
+static inline size_t row_digit (const Word *r, const size_t k, const size_t nbytes) {
+  const size_t b = nbytes - 1 - k;
+  return (r[b / 8] >> (8 * (b % 8))) & 0xff;
+}
+
+// the order of Row on packed rows: the words compared as numbers, last first
+static inline bool row_less (const Word *a, const Word *b, const size_t nw) {
+  for (size_t w = nw; w-- > 0; )
+    if (a[w] != b[w])
+      return a[w] < b[w];
+  return false;
+}
+
+// buckets smaller than this are left to introsort
+const size_t RADIXCUT = 64;
+
+// distributes perm[lo, hi) by byte k of the rows of M (counting sort);
+// returns the start of every bucket and, as last entry, hi
+static vector<size_t> distribute (const BitMatrix &M, vector<size_t> &perm,
+				  vector<size_t> &temp, const size_t lo,
+				  const size_t hi, const size_t k, const size_t nbytes) {
+  vector<size_t> start(257, 0);
+  for (size_t i = lo; i < hi; ++i)
+    ++start[row_digit(M.row(perm[i]), k, nbytes) + 1];
+  start[0] = lo;
+  for (size_t d = 0; d < 256; ++d)
+    start[d+1] += start[d];
+  vector<size_t> next(start.cbegin(), start.cend() - 1);
+  for (size_t i = lo; i < hi; ++i)
+    temp[next[row_digit(M.row(perm[i]), k, nbytes)]++] = perm[i];
+  copy(temp.cbegin() + lo, temp.cbegin() + hi, perm.begin() + lo);
+  return start;
+}
+
+// MSD radix sort of perm[lo, hi) by the bytes k, k+1, ... of the rows of M
+static void radix_sort (const BitMatrix &M, vector<size_t> &perm,
+			vector<size_t> &temp, const size_t lo, const size_t hi,
+			const size_t k, const size_t nbytes) {
+  if (hi - lo < RADIXCUT) {
+    const size_t stride = M.row_stride();
+    sort(perm.begin() + lo, perm.begin() + hi,
+	 [&M, stride] (const size_t a, const size_t b) {
+	   return row_less(M.row(a), M.row(b), stride);
+	 });
+    return;
+  }
+  if (k == nbytes)
+    return;			// all rows equal
+  const vector<size_t> start = distribute(M, perm, temp, lo, hi, k, nbytes);
+  for (size_t d = 0; d < 256; ++d)
+    if (start[d+1] > start[d])
+      radix_sort(M, perm, temp, start[d], start[d+1], k+1, nbytes);
+}
+
+// sorts the rows of M in the order of Row and removes the duplicates;
+// the buckets of the first byte are sorted in parallel
+static void sort_unique (BitMatrix &M) {
+  const size_t n = M.size();
+  const size_t nbytes = (M.num_cols() + 7) / 8;
+  vector<size_t> perm(n), temp(n);
+  iota(perm.begin(), perm.end(), 0);
+  if (n < RADIXCUT || nbytes == 0)
+    radix_sort(M, perm, temp, 0, n, 0, nbytes);
+  else {
+    const vector<size_t> start = distribute(M, perm, temp, 0, n, 0, nbytes);
+    parallel_for(256,
+		 [&] (const size_t d) {
+		   radix_sort(M, perm, temp, start[d], start[d+1], 1, nbytes);
+		 });
   }
+
+  const size_t stride = M.row_stride();
+  BitMatrix S(M.num_cols());
+  S.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+    if (i == 0 || ! bits_equal(M.row(perm[i]), M.row(perm[i-1]), stride))
+      S.append(M.row(perm[i]));
+  M = move(S);
+}
+
+// the rows of T, without duplicates, that are not the minimum of the
+// other rows above them; they generate the Horn closure of T on every
+// section and give the same minimum of the rows above any tuple
+BitMatrix meet_irreducible (const BitMatrix &T) {
+  BitMatrix R = T;
+  sort_unique(R);
+  const BitMatrix C = R.transpose();
+  const size_t ncols = R.num_cols();
+  const size_t nw = C.row_stride();
+  vector<char> irreducible(R.size(), true);
+  parallel_for(R.size(),
+	       [&] (const size_t i) {
+		 thread_local vector<Word> above;
+		 above.resize(nw);
+		 bits_ones(above.data(), R.size());
+		 above[i / WORDBITS] &= ~(Word(1) << (i % WORDBITS));
+		 const Word *r = R.row(i);
+		 for (size_t w = 0; w < R.row_stride(); ++w)
+		   for (Word bits = r[w]; bits != 0; bits &= bits - 1)
+		     bits_and(above.data(), above.data(),
+			      C.row(w * WORDBITS + ctz64(bits)), nw);
+		 if (! bits_any(above.data(), nw))
+		   return;
+		 // the minimum of the rows above is r iff each 0 of r is in one of them
+		 for (size_t w = 0; w < R.row_stride(); ++w)
+		   for (Word bits = ~r[w]; bits != 0; bits &= bits - 1) {
+		     const size_t j = w * WORDBITS + ctz64(bits);
+		     if (j >= ncols)
+		       break;
+		     if (bits_geq(C.row(j), above.data(), nw))
+		       return;
+		   }
+		 irreducible[i] = false;
+	       },
+	       16);
+
+  BitMatrix M(ncols);
+  for (size_t i = 0; i < R.size(); ++i)
+    if (irreducible[i])
+      M.append(R.row(i));
+  return M;
 }
 
 Matrix restrict (const Row &sect, const Matrix &A) {
   // restricts matrix A to columns determined by the bitvector sect
-  Matrix AA = section(sect, A);
-  // sort(AA.begin(), AA.end());
-  sort_mf(AA, 0, AA.size()-1);
-  auto ip = unique(AA.begin(), AA.end());
-  AA.resize(distance(AA.begin(), ip));
-  return AA;
+  BitMatrix M = pack(A, sect.size());
+  Words mask(M.row_stride());
+  pack(sect, mask.data());
+  M.restrict(mask.data());
+  sort_unique(M);
+  return unpack(M);
 }
 
 //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -988,7 +1412,7 @@ Formula unitres (const Formula &formula) {
     size_t index = 0;
     while (index < unit_i.size() && unit_i[index] == lnone)
       index++;
-    if (index < ru_bound) {
+    if (index < unit_i.size()) {
       for (int j=i+1; j < ru_bound; ++j) {
 	Clause unit_j = resUnits[j];
 	if (unit_i[index] == lpos && unit_j[index] == lneg
@@ -1072,24 +1496,73 @@ bool subsumes (const Clause &cla, const Clause &clb) {
   return true;
 }
 
+// literals of a clause, 2v for x_v and 2v+1 for not x_v
+static vector<size_t> literal_codes (const Clause &clause) {
+  vector<size_t> lits;
+  for (size_t v = 0; v < clause.size(); ++v)
+    if (clause[v] == lpos)
+      lits.push_back(2*v);
+    else if (clause[v] == lneg)
+      lits.push_back(2*v + 1);
+  return lits;
+}
+
 // perform subsumption on clauses of a formula
 // clauses must be sorted by length --- IS GUARANTEED
+// subsumption is transitive, hence a clause goes iff an earlier one
+// subsumes it; the earlier clauses are listed under their rarest literal
+// and a 64-bit signature of their literals filters the candidates
 Formula subsumption (Formula formula) {	
-  Formula res;
-  // sort_mf not necessary, clauses are GUARANTEED SORTED
-  // sort(formula.begin(), formula.end(), cmp_numlit);
-  // sort_mf(formula, 0, formula.size()-1);
-  while (! formula.empty()) {
-    Clause clause = formula.front();
-    formula.pop_front();
-    auto it = formula.begin();
-    while (it != formula.end())
-      if (subsumes(clause, *it))
-	it = formula.erase(it);
-      else
-	++it;
-    res.push_back(clause);
+  const size_t m = formula.size();
+  if (m == 0)
+    return formula;
+  const size_t lngt = formula[0].size();
+
+  vector<vector<size_t>> lits(m);
+  vector<Word> signature(m, 0);
+  vector<size_t> frequency(2 * lngt, 0);
+  size_t first_empty = m;
+  for (size_t k = 0; k < m; ++k) {
+    lits[k] = literal_codes(formula[k]);
+    for (const size_t l : lits[k]) {
+      signature[k] |= Word(1) << (l % WORDBITS);
+      ++frequency[l];
+    }
+    if (lits[k].empty() && first_empty == m)
+      first_empty = k;
   }
+  vector<vector<size_t>> occurs(2 * lngt);
+  for (size_t k = 0; k < m; ++k)
+    if (! lits[k].empty())
+      occurs[*min_element(lits[k].cbegin(), lits[k].cend(),
+			  [&frequency] (const size_t a, const size_t b) {
+			    return frequency[a] < frequency[b];
+			  })].push_back(k);
+
+  vector<char> removed(m, false);
+  parallel_for(m,
+	       [&] (const size_t k) {
+		 if (first_empty < k) {
+		   removed[k] = true;
+		   return;
+		 }
+		 for (const size_t l : lits[k])
+		   for (const size_t c : occurs[l]) {
+		     if (c >= k)
+		       break;
+		     if ((signature[c] & ~signature[k]) == 0
+			 && subsumes(formula[c], formula[k])) {
+		       removed[k] = true;
+		       return;
+		     }
+		   }
+	       },
+	       64);
+
+  Formula res;
+  for (size_t k = 0; k < m; ++k)
+    if (! removed[k])
+      res.push_back(move(formula[k]));
   return res;
 }
 
@@ -1101,8 +1574,160 @@ bool empty_clause (const Clause &clause) {
   return true;
 }
 
+// Unit resolution of unitres on a formula loaded once.  The distinct
+// clauses, and all unit clauses, are ranked in string order, so that the
+// loaded ones are visited in the order unitres sees them after sort_mf and
+// unique.  A unit is propagated through the occurrence lists of the
+// opposite literal, keeping for every clause the number and the sum of its
+// remaining literals, as in forward chaining for Horn-SAT; only the clauses
+// touched by a query are reset.  Literal 2v is x_v, 2v+1 is not x_v.
+class UnitResolution {
+private:
+  size_t lngt;
+  vector<Clause> ranked;		// distinct clauses in string order
+  vector<size_t> present;		// loaded copies of every clause
+  vector<size_t> nlits;			// number of literals of every clause
+  vector<size_t> litsum;		// sum of the literals of every clause
+  vector<size_t> unit_rank;		// rank of the unit clause of every literal
+  vector<size_t> unit_order;		// literals by rank of their unit clause
+  vector<vector<size_t>> occurs;	// clauses with >= 2 literals, per literal
+  size_t nonunits = 0;			// loaded clauses with >= 2 literals
+  size_t empties = 0;			// loaded empty clauses
+
+  // scratch of one query
+  vector<size_t> remaining, rest;
+  vector<char> touched, moved, extra, processed, derived;
+
+  inline size_t rank (const Clause &clause) const {
+    return lower_bound(ranked.cbegin(), ranked.cend(), clause) - ranked.cbegin();
+  }
+
+  void count (const size_t r, const int delta) {
+    if (delta > 0 ? present[r]++ > 0 : --present[r] > 0)
+      return;			// only the first and the last copy count
+    if (nlits[r] == 0)
+      empties += delta;
+    else if (nlits[r] > 1)
+      nonunits += delta;
+  }
+
+public:
+  UnitResolution (const Formula &formula, const size_t n) : lngt(n) {
+    ranked.assign(formula.cbegin(), formula.cend());
+    for (size_t v = 0; v < lngt; ++v)
+      for (const Literal lit : {lpos, lneg}) {
+	Clause unit(lngt, lnone);
+	unit[v] = lit;
+	ranked.push_back(unit);
+      }
+    sort(ranked.begin(), ranked.end());
+    ranked.erase(unique(ranked.begin(), ranked.end()), ranked.end());
+
+    const size_t size = ranked.size();
+    present.assign(size, 0);
+    nlits.assign(size, 0);
+    litsum.assign(size, 0);
+    occurs.resize(2 * lngt);
+    unit_rank.resize(2 * lngt);
+    for (size_t r = 0; r < size; ++r) {
+      const vector<size_t> lits = literal_codes(ranked[r]);
+      nlits[r] = lits.size();
+      litsum[r] = accumulate(lits.cbegin(), lits.cend(), size_t(0));
+      if (lits.size() == 1)
+	unit_rank[lits[0]] = r;
+      else
+	for (const size_t l : lits)
+	  occurs[l].push_back(r);
+    }
+    unit_order.resize(2 * lngt);
+    iota(unit_order.begin(), unit_order.end(), 0);
+    sort(unit_order.begin(), unit_order.end(),
+	 [this] (const size_t a, const size_t b) {
+	   return unit_rank[a] < unit_rank[b];
+	 });
+    remaining.assign(size, 0);
+    rest.assign(size, 0);
+    touched.assign(size, false);
+    moved.assign(size, false);
+    extra.assign(size, false);
+    processed.assign(2 * lngt, false);
+    derived.assign(2 * lngt, false);
+
+    for (const Clause &clause : formula)
+      load(clause);
+  }
+
+  void load (const Clause &clause) { count(rank(clause), +1); }
+  void unload (const Clause &clause) { count(rank(clause), -1); }
+
+  // does unitres find the empty clause in the loaded clauses together
+  // with the unit clauses of the literals in units?
+  bool refutes (const vector<size_t> &units) {
+    if (empties > 0)
+      return true;
+
+    // the units in string order, duplicates once
+    for (const size_t l : units)
+      extra[unit_rank[l]] = true;
+    deque<size_t> queue;
+    vector<size_t> lits;			// distinct literals of the units
+    for (const size_t l : unit_order)
+      if (present[unit_rank[l]] > 0 || extra[unit_rank[l]]) {
+	queue.push_back(l);
+	derived[l] = true;
+	lits.push_back(l);
+      }
+    for (const size_t l : units)
+      extra[unit_rank[l]] = false;
+
+    vector<size_t> reset;			// clauses touched
+    size_t active = nonunits;
+    while (! queue.empty() && active > 0) {
+      const size_t l = queue.front();
+      queue.pop_front();
+      if (processed[l])
+	continue;				// no clause left to shorten
+      processed[l] = true;
+      for (const size_t r : occurs[l ^ 1]) {
+	if (present[r] == 0 || moved[r])
+	  continue;
+	if (! touched[r]) {
+	  touched[r] = true;
+	  reset.push_back(r);
+	  remaining[r] = nlits[r];
+	  rest[r] = litsum[r];
+	}
+	rest[r] -= l ^ 1;
+	if (--remaining[r] == 1) {		// in string order, as unitres
+	  moved[r] = true;
+	  --active;
+	  queue.push_back(rest[r]);
+	  if (! derived[rest[r]]) {
+	    derived[rest[r]] = true;
+	    lits.push_back(rest[r]);
+	  }
+	}
+      }
+    }
+
+    // a pair of opposite units is the empty clause
+    bool refuted = false;
+    for (const size_t l : lits)
+      if (derived[l] && derived[l ^ 1])
+	refuted = true;
+
+    for (const size_t r : reset)
+      touched[r] = moved[r] = false;
+    for (const size_t l : lits)
+      derived[l] = processed[l] = false;
+    return refuted;
+  }
+};
+
 // eliminating redundant clauses
 // clauses must be sorted by length --- IS GUARANTEED
+// a clause is redundant if unit resolution refutes the other clauses
+// together with the negation of its literals
 Formula redundant (const Formula &formula) {	
   const int lngt = formula[0].size();
 
@@ -1112,6 +1737,7 @@ Formula redundant (const Formula &formula) {
   // sort_mf not necessary, clauses are GUARANTEED SORTED
   // sort(prefix.begin(), prefix.end(), cmp_numlit);
   // sort_mf(prefix, 0, prefix.size()-1);
+  UnitResolution resolution(formula, lngt);
 
   size_t left = 0;
   while (left < prefix.size() && numlit(prefix[left]) == 1)
@@ -1120,29 +1746,15 @@ Formula redundant (const Formula &formula) {
   while (left < prefix.size()) {
     Clause pivot = prefix.back();
     prefix.pop_back();
-    Formula newUnits;
-    for (size_t i = 0; i < pivot.size(); ++i) {
-      if (pivot[i] != lnone) {
-	Clause newclause(lngt, lnone);
-	newclause[i] = (pivot[i] == lpos) ? lneg : lpos;
-	newUnits.push_back(newclause);
-      }
-    }
-    newUnits.insert(newUnits.end(), prefix.begin(), prefix.end());
-    newUnits.insert(newUnits.end(), suffix.begin(), suffix.end());
-    // sort(newUnits.begin(), newUnits.end(), cmp_numlit);
-    sort_mf(newUnits, 0, newUnits.size()-1);
-    auto last3 = unique(newUnits.begin(), newUnits.end());
-    newUnits.erase(last3, newUnits.end());
-    Formula bogus = unitres(newUnits);
-    bool keep = true;
-    for (const Clause &bgcl : bogus)
-      if (empty_clause(bgcl)) {
-	keep = false;
-	break;
-      }
-    if (keep)
+    resolution.unload(pivot);
+    vector<size_t> negated;
+    for (size_t i = 0; i < pivot.size(); ++i)
+      if (pivot[i] != lnone)
+	negated.push_back(2*i + (pivot[i] == lpos));
+    if (! resolution.refutes(negated)) {
       suffix.push_front(pivot);
+      resolution.load(pivot);
+    }
   }
   prefix.insert(prefix.end(), suffix.begin(), suffix.end());
   return prefix;
@@ -1152,62 +1764,232 @@ Formula redundant (const Formula &formula) {
 // Universe = tuples in F
 // SubSets  = clauses of a formula
 Formula SetCover (const Matrix &Universe, const Formula &SubSets) {
-  enum Presence {NONE = 0, ABSENT = 1, PRESENT = 2};
-  typedef pair<Row, Clause> Falsification;	
-  map<Falsification, Presence> incidence;	// Incidence matrix indicating
-						// which tuple (row) falsifies which clause
-  Matrix R;					// tuples still active == not yet falsified
+  // row k of the incidence bitmaps holds the tuples falsifying SubSets[k];
+  // the greedy choice is lazy: scores only decrease, so a clause whose
+  // score is still exact when it tops the queue is the first best one
   Formula selected;				// selected clauses for falsification
-
-  for (const Row &tuple : Universe) {
-    R.push_back(tuple);
-    for (Clause clause : SubSets)
-      incidence[make_pair(tuple, clause)]
-	= sat_clause(tuple, clause) ? ABSENT : PRESENT;
-  }
+  if (Universe.empty())
+    return selected;
+  const BitMatrix U = pack(Universe, Universe[0].size());
+  BitMatrix incidence(U.size());
+  incidence.reserve(SubSets.size());
+  for (size_t k = 0; k < SubSets.size(); ++k)
+    incidence.append();
+  const size_t nw = incidence.row_stride();
+  parallel_for(SubSets.size(),
+	       [&] (const size_t k) {
+		 vector<Word> pos(U.row_stride(), 0), neg(U.row_stride(), 0);
+		 for (size_t j = 0; j < SubSets[k].size(); ++j)
+		   if (SubSets[k][j] == lpos)
+		     pos[j / WORDBITS] |= Word(1) << (j % WORDBITS);
+		   else if (SubSets[k][j] == lneg)
+		     neg[j / WORDBITS] |= Word(1) << (j % WORDBITS);
+		 Word *falsified = incidence.row(k);
+		 for (size_t i = 0; i < U.size(); ++i)
+		   if (! bits_sat(U.row(i), pos.data(), neg.data(), U.row_stride()))
+		     falsified[i / WORDBITS] |= Word(1) << (i % WORDBITS);
+	       });
+
+  // a clause occurring several times in SubSets scores several times
+  map<Clause, size_t> occurrences;
+  for (const Clause &clause : SubSets)
+    ++occurrences[clause];
+  vector<size_t> multiplicity(SubSets.size());
+  for (size_t k = 0; k < SubSets.size(); ++k)
+    multiplicity[k] = occurrences[SubSets[k]];
+
+  Words active(nw);				// tuples not yet falsified
+  bits_ones(active.data(), U.size());
+  auto score = [&] (const size_t k) {
+    return multiplicity[k] * bits_count_and(incidence.row(k), active.data(), nw);
+  };
+
+  // highest score first, on a tie the clause coming first in SubSets
+  typedef pair<size_t, size_t> Entry;		// score and index of a clause
+  auto lower = [] (const Entry &a, const Entry &b) {
+    return a.first < b.first || (a.first == b.first && a.second > b.second);
+  };
+  priority_queue<Entry, vector<Entry>, decltype(lower)> queue(lower);
+  vector<size_t> initial(SubSets.size());
+  parallel_for(SubSets.size(), [&] (const size_t k) { initial[k] = score(k); });
+  for (size_t k = 0; k < SubSets.size(); ++k)
+    if (initial[k] > 0)
+      queue.emplace(initial[k], k);
 
   // perform set cover
-  while (!R.empty()) {
-    // How many tuples does the clause falsify (intersect)?
-    map<Clause, size_t> intersect;
-    for (const Clause &clause : SubSets)
-      intersect[clause] = 0;
-#pragma omp parallel for
-    for (const Row &tuple : R)
-#pragma omp parallel for
-      for (const Clause &clause : SubSets)
-	if (incidence[make_pair(tuple, clause)] == PRESENT)
-	  ++intersect[clause];
-
-    size_t maxw = 0;
-    Clause maxset;
-    for (const Clause &clause : SubSets)
-      if (intersect[clause] > maxw) {
-	maxw = intersect[clause];
-	maxset = clause;
-      }
-
-    if (maxw == 0)
-      break;
-    selected.push_back(maxset);
-    
-    auto it = R.begin();
-    while (it != R.end())
-      if (incidence[make_pair(*it, maxset)] == PRESENT) {
-	for (const Clause &clause : SubSets)
-	  incidence[make_pair(*it, clause)] = ABSENT;
-	it = R.erase(it);
-      } else
-	++it;
+  while (! queue.empty()) {
+    const size_t k = queue.top().second;
+    const size_t stale = queue.top().first;
+    queue.pop();
+    const size_t fresh = score(k);
+    if (fresh == 0)
+      continue;
+    if (fresh < stale) {
+      queue.emplace(fresh, k);
+      continue;
+    }
+    selected.push_back(SubSets[k]);
+    const Word *falsified = incidence.row(k);
+    for (size_t w = 0; w < nw; ++w)
+      active[w] &= ~falsified[w];
   }
+
   // sort(selected.begin(), selected.end(), cmp_numlit);
   sort_mf(selected, 0, selected.size()-1);
   return selected;
 }
 
 // perform redundancy elimination on formula according to cooking
+// strongly connected components of a graph (Tarjan), numbered in the
+// order they are completed: an arc never leads to a higher number
+static vector<size_t> strong_components (const vector<vector<size_t>> &arcs,
+					 size_t &count) {
+  const size_t n = arcs.size();
+  const size_t UNSEEN = n;
+  vector<size_t> index(n, UNSEEN), low(n, 0), component(n, UNSEEN);
+  vector<size_t> stack;
+  vector<pair<size_t,size_t>> path;	// vertex and its next arc
+  size_t counter = 0;
+  count = 0;
+  for (size_t s = 0; s < n; ++s) {
+    if (index[s] != UNSEEN)
+      continue;
+    index[s] = low[s] = counter++;
+    stack.push_back(s);
+    path.push_back({s, 0});
+    while (! path.empty()) {
+      const size_t v = path.back().first;
+      if (path.back().second < arcs[v].size()) {
+	const size_t w = arcs[v][path.back().second++];
+	if (index[w] == UNSEEN) {
+	  index[w] = low[w] = counter++;
+	  stack.push_back(w);
+	  path.push_back({w, 0});
+	} else if (component[w] == UNSEEN)
+	  low[v] = min(low[v], index[w]);
+	continue;
+      }
+      if (low[v] == index[v]) {
+	size_t w;
+	do {
+	  w = stack.back();
+	  stack.pop_back();
+	  component[w] = count;
+	} while (w != v);
+	++count;
+      }
+      path.pop_back();
+      if (! path.empty())
+	low[path.back().first] = min(low[path.back().first], low[v]);
+    }
+  }
+  return component;
+}
+
+// are all clauses of one or two literals?
+static bool two_cnf (const Formula &formula) {
+  for (const Clause &clause : formula) {
+    const size_t n = numlit(clause);
+    if (n == 0 || n > 2)
+      return false;
+  }
+  return true;
+}
+
+// clause of one or two literals given by their codes
+static Clause code_clause (const size_t lngt, const size_t a, const size_t b) {
+  Clause clause(lngt, lnone);
+  clause[a/2] = (a & 1) ? lneg : lpos;
+  clause[b/2] = (b & 1) ? lneg : lpos;
+  return clause;
+}
+
+// cooking of a 2-CNF formula on its implication graph, instead of the
+// resolution steps of cook: a clause (a + b) gives the arcs -a -> b and
+// -b -> a, a unit (a) the arc -a -> a.  The literals of a strongly
+// connected component are equivalent and chained in a cycle, a literal
+// reachable from its negation is a unit, and the arcs between components
+// become clauses on their least literals, transitively reduced if well done.
+static Formula cook2sat (const Formula &formula) {
+  const size_t lngt = formula[0].size();
+  vector<vector<size_t>> arcs(2 * lngt);
+  for (const Clause &clause : formula) {
+    const vector<size_t> lits = literal_codes(clause);
+    const size_t a = lits.front(), b = lits.back();
+    arcs[a ^ 1].push_back(b);
+    if (a != b)
+      arcs[b ^ 1].push_back(a);
+  }
+
+  size_t count;
+  const vector<size_t> component = strong_components(arcs, count);
+  for (size_t v = 0; v < lngt; ++v)
+    if (component[2*v] == component[2*v + 1])
+      return Formula(1, Clause(lngt, lnone));	// unsatisfiable
+
+  vector<vector<size_t>> members(count), next(count);
+  for (size_t l = 0; l < 2 * lngt; ++l) {
+    members[component[l]].push_back(l);
+    for (const size_t m : arcs[l])
+      if (component[m] != component[l])
+	next[component[l]].push_back(component[m]);
+  }
+
+  // sinks first; the successors of a component nearest first, so that an
+  // arc is kept only if no kept arc leads to its end already
+  BitMatrix reach(count);
+  for (size_t c = 0; c < count; ++c)
+    reach.append();
+  vector<pair<size_t,size_t>> kept;
+  for (size_t c = 0; c < count; ++c) {
+    sort(next[c].begin(), next[c].end(), greater<size_t>());
+    next[c].erase(unique(next[c].begin(), next[c].end()), next[c].end());
+    Word *rc = reach.row(c);
+    for (const size_t d : next[c]) {
+      if (reach.get(c, d) && cooking == ckWELLDONE)
+	continue;
+      kept.push_back({c, d});
+      reach.set(c, d);
+      const Word *rd = reach.row(d);
+      for (size_t w = 0; w < reach.row_stride(); ++w)
+	rc[w] |= rd[w];
+    }
+  }
+
+  // a component is forced if its negation reaches it, or the other way
+  vector<char> forced(count, false);
+  Formula result;
+  for (size_t v = 0; v < lngt; ++v) {
+    const size_t p = component[2*v], n = component[2*v + 1];
+    if (reach.get(n, p) || reach.get(p, n)) {
+      forced[p] = forced[n] = true;
+      const size_t l = reach.get(n, p) ? 2*v : 2*v + 1;
+      result.push_back(code_clause(lngt, l, l));
+    }
+  }
+  // cycles through the equivalent literals, one of every dual pair
+  for (const vector<size_t> &lits : members)
+    if (lits.size() > 1 && ! forced[component[lits[0]]] && lits[0] % 2 == 0)
+      for (size_t k = 0; k < lits.size(); ++k)
+	result.push_back(code_clause(lngt, lits[k] ^ 1,
+				     lits[(k + 1) % lits.size()]));
+  // a kept arc and its dual give the same clause
+  for (const pair<size_t,size_t> &arc : kept)
+    if (! forced[arc.first] && ! forced[arc.second])
+      result.push_back(code_clause(lngt, members[arc.first][0] ^ 1,
+				   members[arc.second][0]));
+
+  sort_mf(result, 0, result.size()-1);
+  result.erase(unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
 void cook (Formula &formula) {
   if (! formula.empty()) {
+    if (closure == clBIJUNCTIVE && cooking > ckRAW && two_cnf(formula)) {
+      formula = cook2sat(formula);
+      return;
+    }
     if (cooking == ckRAW)      sort_mf(formula, 0, formula.size()-1);
     // sort(formula.begin(), formula.end(), cmp_numlit);
     if (cooking >= ckBLEU)     {formula = unitres(formula);
@@ -1219,141 +2001,190 @@ void cook (Formula &formula) {
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
+// The tables of Zanuttini's algorithm are indexed by the position of a row
+// in the lexicographically sorted matrix R.  Copies of a row get the values
+// of its last copy, as when the tables were keyed by the rows themselves.
+
+// length of the common prefix of two rows of nbits bits, word by word
+static inline int common_prefix (const Word *a, const Word *b,
+				 const size_t nw, const size_t nbits) {
+  for (size_t w = 0; w < nw; ++w)
+    if (a[w] != b[w])
+      return w * WORDBITS + ctz64(a[w] ^ b[w]);
+  return nbits;
+}
+
+// position of the last copy of every row of R
+static vector<size_t> last_copy (const BitMatrix &R) {
+  vector<size_t> last(R.size());
+  for (size_t i = R.size(); i-- > 0; )
+    last[i] = i + 1 < R.size() && bits_equal(R.row(i), R.row(i+1), R.row_stride())
+      ? last[i+1] : i;
+  return last;
+}
+
 // predecessor function of Zanuttini's algorithm
 // R must be lexicographically sorted
-map<Row, int> predecessor (const Matrix &R) {
-  map<Row, int> pred;
-  pred[R[0]] = SENTINEL;
-  Row p = R[0];
-  for (size_t i = 1; i < R.size(); ++i) {
-    Row m = R[i];
-    size_t j = 0;
-    for (size_t k = 0; k < m.size(); ++k)
-      if (m[k] == p[k])
-	j++;
-      else
-	break;
-    pred[R[i]] = j;
-    p = m;
+vector<int> predecessor (const BitMatrix &R) {
+  const vector<size_t> last = last_copy(R);
+  vector<int> pred(R.size());
+  for (size_t i = 0; i < R.size(); ++i) {
+    const size_t e = last[i];
+    pred[i] = e == 0
+      ? SENTINEL
+      : common_prefix(R.row(e-1), R.row(e), R.row_stride(), R.num_cols());
   }
   return pred;
 }
 
 // sucessor function of Zanuttini's algorithm
 // R must be lexicographically sorted
-map<Row, int> successor (const Matrix &R) {
-  map<Row, int> succ;
-  Row m = R[0];
-  for (size_t i = 1; i < R.size(); ++i) {
-    Row s = R[i];
-    size_t j = 0;
-    for (size_t k = 0; k < m.size(); ++k)
-      if (m[k] == s[k])
-	j++;
-      else
-	break;
-    succ[R[i-1]] = j;
-    m = s;
+vector<int> successor (const BitMatrix &R) {
+  const vector<size_t> last = last_copy(R);
+  vector<int> succ(R.size());
+  for (size_t i = 0; i < R.size(); ++i) {
+    const size_t e = last[i];
+    succ[i] = e + 1 == R.size()
+      ? SENTINEL
+      : common_prefix(R.row(e), R.row(e+1), R.row_stride(), R.num_cols());
   }
-  succ[R[R.size()-1]] = SENTINEL;
   return succ;
 }
 
-// sim array of Zanuttini's algorithm
-map<Row, vector<int>> simsim (const Matrix &R, const map<Row, int> &succ) {
-  map<Row, vector<int>> sim;
-  for (const Row &mm : R) {
-    const vector<int> dummy(mm.size(), SENTINEL);
-    sim[mm] = dummy;
-    for (const Row &m1m : R) {
-      if (mm == m1m)
-	continue;
-      int j0 = 0;
-      while (mm[j0] == m1m[j0])
-	++j0;
-      int j = j0;
-      while (j < m1m.size() && (m1m[j] || ! mm[j])) {
-	if (j > succ.at(mm) && ! mm[j] && m1m[j])
-	  sim[mm][j] = max(sim[mm][j], j0);
-	j++;
-      }
-    }
-  }
+// sim array of Zanuttini's algorithm, one row of lngt entries per row of R:
+// for mm and every other m1m with common prefix j0, the scan from j0 stops
+// at the first j where mm is 1 and m1m is 0; before it, every j > succ(mm)
+// where mm is 0 and m1m is 1 gets at least j0; the rows mm run in parallel
+vector<int> simsim (const BitMatrix &R, const vector<int> &succ) {
+  const size_t lngt = R.num_cols();
+  const size_t nw = R.row_stride();
+  vector<int> sim(R.size() * lngt, SENTINEL);
+  parallel_for(R.size(),
+	       [&] (const size_t a) {
+		 const Word *mm = R.row(a);
+		 int *sima = sim.data() + a * lngt;
+		 const size_t from = succ[a] + 1;	// succ[a] == SENTINEL gives 0
+		 for (size_t b = 0; b < R.size(); ++b) {
+		   const Word *m1m = R.row(b);
+		   const size_t j0 = common_prefix(mm, m1m, nw, lngt);
+		   if (j0 == lngt)
+		     continue;			// a copy of mm
+		   for (size_t w = j0 / WORDBITS; w < nw; ++w) {
+		     Word range = ~Word(0);
+		     if (w == j0 / WORDBITS)
+		       range <<= j0 % WORDBITS;
+		     const Word stop = mm[w] & ~m1m[w] & range;
+		     if (stop != 0)
+		       range &= (stop & -stop) - 1;
+		     Word gain = ~mm[w] & m1m[w] & range;
+		     if (from > w * WORDBITS)
+		       gain &= from >= (w+1) * WORDBITS ? 0 : ~Word(0) << (from - w * WORDBITS);
+		     for (; gain != 0; gain &= gain - 1) {
+		       const size_t j = w * WORDBITS + ctz64(gain);
+		       sima[j] = max(sima[j], int(j0));
+		     }
+		     if (stop != 0)
+		       break;
+		   }
+		 }
+	       },
+	       16);
   return sim;
 }
 
 // generate clauses with Zanuttini's algorithm
-Clause hext (const Row &m, const int &j,
-	     const map<Row, int> &pred, const map<Row, int> &succ,
-	     const map<Row, vector<int>> &sim) {
+// pred, succ and sim are the entries of the table for m
+Clause hext (const RowView &m, const int &j,
+	     const int pred, const int succ, const int *sim) {
   Clause clause(m.size(), lnone);
   for (size_t i = 0; i < j; ++i)
     if (m[i])
       clause[i] = lneg;
-  if (j > pred.at(m) && m[j])
+  if (j > pred && m[j])
     clause[j] = lpos;
-  else if (j > succ.at(m) && ! m[j] && sim.at(m)[j] == SENTINEL)
+  else if (j > succ && ! m[j] && sim[j] == SENTINEL)
     clause[j] = lneg;
-  else if (j > succ.at(m) && ! m[j] && sim.at(m)[j] != SENTINEL) {
+  else if (j > succ && ! m[j] && sim[j] != SENTINEL) {
     clause[j] = lneg;
-    clause[sim.at(m)[j]] = lpos;
+    clause[sim[j]] = lpos;
   }
   return clause;
 }
 
 // phi is a CNF formula and M is a set of tuples, such that sol(phi) = M
 // constructs a reduced prime formula phiPrime, such that sol(phi) = sol(phiPrime)
+// M is kept column wise: bitmap j holds the tuples with a 1 in coordinate j.
+// For a clause, last[k] is the last literal satisfied by tuple k; the tuples
+// with last[k] == j are the satisfying tuples of literal j minus those of
+// the later literals.  Once a literal is kept, last[k] is reset for every
+// tuple with a 1, so only the zero tuples count further on.  The clauses
+// are reduced in parallel.
 Formula primality (const Formula &phi, const Matrix &M) {
   const size_t card = M.size();
   const size_t lngt = M[0].size();
-  Formula phiPrime;
-
-  auto last = make_unique<int []>(card);	// smart pointer
-  // int *last = new int[card];			// hard pointer
-  for (Clause clause : phi) {
+  for (const Clause &clause : phi)
     if (clause.size() != lngt) {
       cerr << "+++ Clause size and vector length do not match" << endl;
       exit(2);
     }
-    for (size_t k = 0; k < card; ++k) {
-      last[k] = SENTINEL;
-      for (size_t j = 0; j < clause.size(); ++j)
-	if (M[k][j] && clause[j] == lpos
-	    ||
-	    ! M[k][j] && clause[j] == lneg)
-	  last[k] = j;
-    }
-    Clause cPrime(clause.size(), lnone);
-    for (size_t j = 0; j < clause.size(); ++j) {
-      bool d;
-      if (clause[j] == lpos) {
-	d = true;
-	for (size_t k = 0; k < card; ++k)
-	  if (last[k] == j)
-	    d = d && M[k][j];
-	if (d)
-	  cPrime[j] = lpos;
-      } else if (clause[j] == lneg) {
-	d = false;
-	for (size_t k = 0; k < card; ++k)
-	  if (last[k] == j)
-	    d = d || M[k][j];
-	if (!d)
-	  cPrime[j] = lneg;
-      }
-      if (cPrime[j] != lnone)
-	for (size_t k = 0; k < card; ++k)
-	  for (size_t i = 0; i < lngt; ++i)
-	    if (M[k][i] && cPrime[j] == lpos
-		||
-		M[k][i] && cPrime[j] == lneg) {
-	      last[k] = SENTINEL;
-	      break;
-	    }
-    }
-    phiPrime.push_back(cPrime);
-  }
-  // delete [] last;	// only for hard pointer, comment out if use smart pointer
+
+  const BitMatrix C = pack(M, lngt).transpose();
+  const size_t nw = C.row_stride();
+  Words zeros(nw);				// tuples without any 1
+  bits_ones(zeros.data(), card);
+  for (size_t j = 0; j < lngt; ++j)
+    for (size_t w = 0; w < nw; ++w)
+      zeros[w] &= ~C.row(j)[w];
+
+  Formula phiPrime(phi.size());
+  parallel_for(phi.size(),
+	       [&] (const size_t c) {
+		 const Clause &clause = phi[c];
+		 vector<size_t> lits;
+		 for (size_t j = 0; j < lngt; ++j)
+		   if (clause[j] == lpos || clause[j] == lneg)
+		     lits.push_back(j);
+
+		 // later[l]: tuples satisfying a literal after lits[l]
+		 BitMatrix later(card);
+		 later.reserve(lits.size() + 1);
+		 for (size_t l = 0; l <= lits.size(); ++l)
+		   later.append();
+		 for (size_t l = lits.size(); l-- > 0; ) {
+		   const Word *col = C.row(lits[l]);
+		   const Word *next = later.row(l+1);
+		   Word *here = later.row(l);
+		   const bool pos = clause[lits[l]] == lpos;
+		   for (size_t w = 0; w < nw; ++w)
+		     here[w] = next[w] | (pos ? col[w] : ~col[w]);
+		   if (card % WORDBITS != 0 && nw > 0)
+		     here[nw-1] &= (Word(1) << (card % WORDBITS)) - 1;
+		 }
+
+		 Clause cPrime(lngt, lnone);
+		 bool kept = false;		// some literal kept, only zero tuples left
+		 for (size_t l = 0; l < lits.size(); ++l) {
+		   const size_t j = lits[l];
+		   const Word *col = C.row(j);
+		   const Word *next = later.row(l+1);
+		   const bool pos = clause[j] == lpos;
+		   // pos: no tuple with last j has a 0 in j, neg: none has a 1
+		   bool d = true;
+		   for (size_t w = 0; w < nw && d; ++w) {
+		     Word last = (pos ? col[w] : ~col[w]) & ~next[w];
+		     if (kept)
+		       last &= zeros[w];
+		     if (pos ? last & ~col[w] : last & col[w])
+		       d = false;
+		   }
+		   if (d) {
+		     cPrime[j] = clause[j];
+		     kept = true;
+		   }
+		 }
+		 phiPrime[c] = cPrime;
+	       },
+	       4);
   return phiPrime;
 }
 
@@ -1379,14 +2210,19 @@ Formula learnHornExact (Matrix T) {
     sort(T.begin(), T.end(), cmp_row);
     // sort_mf(T, 0, T.size()-1);
 
-    map<Row, int> succ = successor(T);		// successor function for Zanuttini's algorithm
-    map<Row, int> pred = predecessor(T);	// predecessor function for Zanuttini's algorithm
-    map<Row, vector<int>> sim = simsim(T, succ);// sim table for Zanuttini's algorithm
-    
-    for (const Row &m : T)
+    const BitMatrix P = pack(T, lngt);
+    const vector<int> succ = successor(P);	// successor function for Zanuttini's algorithm
+    const vector<int> pred = predecessor(P);	// predecessor function for Zanuttini's algorithm
+    const vector<int> sim = simsim(P, succ);	// sim table for Zanuttini's algorithm
+
+    // a SENTINEL entry never lets a clause through here
+    for (size_t i = 0; i < P.size(); ++i) {
+      const RowView m = P[i];
       for (size_t j = 0; j < lngt; ++j)
-	if (j > pred.at(m) && m[j] || j > succ.at(m) && ! m[j])
-	  H.push_back(hext(m,j, pred, succ, sim));
+	if ((pred[i] != SENTINEL && j > size_t(pred[i]) && m[j])
+	    || (succ[i] != SENTINEL && j > size_t(succ[i]) && ! m[j]))
+	  H.push_back(hext(m, j, pred[i], succ[i], sim.data() + i * lngt));
+    }
     
     H = primality(H, T);
     cook(H);
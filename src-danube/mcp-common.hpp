@@ -29,6 +29,7 @@
 #include <vector>
 #include <deque>
 #include <map>
+#include <functional>
 #include "mcp-matrix+formula.hpp"
 
 using namespace std;
@@ -58,7 +59,9 @@ enum Parameter : size_t {parERROR = 0,
 			 parMATRIX = 16,
 			 parOFFSET = 17,
 			 parCHUNK = 18,
-			 parDEBUG = 19};
+			 parTHREADS = 19,
+			 parBUFFER = 20,
+			 parDEBUG = 21};
 
 enum Closure : char  {clERROR      = 0,
 		      clHORN       = 1,
@@ -80,7 +83,8 @@ enum Direction : char {dERROR      = 0,
 		       dRAND       = 4,
 		       dLOWSCORE   = 5,
 		       dHIGHSCORE  = 6,
-		       dPREC       = 7};
+		       dPREC       = 7,
+		       dBLOCK      = 8};
 
 extern const string STDIN;
 extern const string STDOUT;
@@ -98,11 +102,13 @@ extern string input;
 extern string output;
 extern string headerput;
 extern string weights;
-extern bool disjoint;
+extern thread_local bool disjoint;	// set by minsect in the thread calling it
 extern int cluster;
 extern string tpath;		// directory where the temporary files will be stored
 extern bool np_fit;
 extern unsigned chunkLIMIT;	// heavily hardware dependent; must be optimized
+extern unsigned nthreads;	// size of the thread pool, 0 = all hardware threads
+extern unsigned bufferLIMIT;	// MB of output kept in memory by mcp-pthread
 extern Arch arch;
 extern string latex;		// file to store latex output
 
@@ -135,12 +141,21 @@ bool operator>= (const Row &a, const Row &b);
 // ostream& operator<< (ostream &output, const Matrix &M);
 Row read_row (const string &line, string &group);
 // Matrix ObsGeq (const Row &a, const Matrix &M);
-unique_ptr<Row> ObsGeq (const Row &a, const Matrix &M);
+unique_ptr<Row> ObsGeq (const RowView &a, const MatrixMask &T);
+bool HornClause (const RowView &f, const MatrixMask &T, Clause &clause);
+// loop over [0, n) in blocks of at least grain indices:
+// sequential in mcp-seq, on the thread pool in mcp-pthread
+void parallel_for (const size_t n, const function<void(size_t)> &body, const size_t grain = 1);
+// is pred true for some index in [0, n)?  stops at the first one found
+bool parallel_any (const size_t n, const function<bool(size_t)> &pred, const size_t grain = 1);
 bool inadmissible (const Matrix &T, const Matrix &F);
+bool inadmissible (const MatrixMask &T, const MatrixMask &F);
 size_t hamming_weight (const Row &row);
 Row minsect (const Matrix &T, const Matrix &F);
 bool satisfied_by (const Clause &clause, const Matrix &T);
+Formula bijunctive_clauses (const Matrix &T, const Matrix *F = nullptr);
 Matrix restrict (const Row &sect, const Matrix &A);
+BitMatrix meet_irreducible (const BitMatrix &T);
 Matrix HornClosure (const Matrix &M);
 Row minHorn (const Matrix &M);
 // void sort_formula (Formula &formula, int low, int high);
@@ -444,6 +444,72 @@ ostream& operator<< (ostream &output, const Matrix &M) {
   return output;
 }
 
+ostream& operator<< (ostream &output, const RowView &row) {
+  for (size_t i = 0; i < row.size(); ++i)
+    output << row[i];
+  return output;
+}
+
+ostream& operator<< (ostream &output, const BitMatrix &M) {
+  for (size_t i = 0; i < M.size(); ++i)
+    output << "\t" << M[i] << endl;
+  return output;
+}
+
+//------------------------------------------------------------------------------
+// conversions between rows and packed words
+// the blocks of a dynamic_bitset have the same layout as the packed words
+
+static_assert(sizeof(Row::block_type) == sizeof(Word));
+
+// the words must have room for row.size() bits
+void pack (const Row &row, Word *words) {
+  boost::to_block_range(row, words);
+}
+
+Row unpack (const Word *words, const size_t nbits) {
+  Row row(words, words + num_words(nbits));
+  row.resize(nbits);		// clears the bits beyond nbits
+  return row;
+}
+
+BitMatrix pack (const Matrix &M, const size_t ncols) {
+  BitMatrix B(ncols);
+  B.reserve(M.size());
+  for (const Row &row : M)
+    push_back(B, row);
+  return B;
+}
+
+BitMatrix pack (const Matrix &M) {
+  BitMatrix B(M.empty() ? 0 : M[0].size());
+  B.reserve(M.size());
+  for (const Row &row : M)
+    push_back(B, row);
+  return B;
+}
+
+Matrix unpack (const BitMatrix &M) {
+  Matrix A;
+  for (size_t i = 0; i < M.size(); ++i)
+    A.push_back(unpack(M.row(i), M.num_cols()));
+  return A;
+}
+
+// the first row fixes the number of columns of an empty matrix;
+// rows of a different arity are cut or padded with 0
+void push_back (BitMatrix &M, const Row &row) {
+  if (M.empty() && M.num_cols() == 0)
+    M = BitMatrix(row.size());
+  if (row.size() == M.num_cols())
+    pack(row, M.append());
+  else {
+    Row temp = row;
+    temp.resize(M.num_cols());
+    pack(temp, M.append());
+  }
+}
+
 void push_front (Row &row1, const Row &row2) {
   Row newrow(row1.size()+row2.size(), row2.to_ulong());
   row1.resize(newrow.size());
@@ -23,51 +23,102 @@
  *                                                                        *
  **************************************************************************/
 
-#include <thread>
+#include <atomic>
 #include "mcp-common.hpp"
 #include "mcp-matrix+formula.hpp"
 #include "mcp-parallel.hpp"
 #include "mcp-posix.hpp"
+#include "mcp-pool.hpp"
 
 using namespace std;
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-void OGchunk (const Row &a, const Matrix &M,
+void OGchunk (const RowView &a, const MatrixMask &T,
 	      unique_ptr<Row> &result,
 	      size_t left, size_t right) {
-  // selects tuples (rows) in M[left..right-1] above the tuple a
+  // minimum of the tuples (rows) of T above the tuple a among the rows
+  // in the words [left..right-1] of the column bitmaps of T
   // usefull for distribution among threads
-  for (size_t i = left; i < right; ++i)
-    if (M[i] >= a)
-      result = make_unique<Row>(result == nullptr ? M[i] : Min(*result, M[i]));
+  const BitMatrix &C = *T.column_index();
+  const Word *mask = T.mask();
+  const size_t nw = right - left;
+  vector<Word> above(nw);
+  bits_ones(above.data(), min(C.num_cols() - left * WORDBITS, nw * WORDBITS));
+  for (size_t w = 0; w < a.nwords(); ++w)
+    for (Word bits = a.data()[w] & mask[w]; bits != 0; bits &= bits - 1)
+      bits_and(above.data(), above.data(), C.row(w * WORDBITS + ctz64(bits)) + left, nw);
+  if (! bits_any(above.data(), nw))
+    return;
+
+  result = make_unique<Row>(a.size());
+  for (size_t w = 0; w < a.nwords(); ++w) {
+    for (Word bits = a.data()[w] & mask[w]; bits != 0; bits &= bits - 1)
+      (*result)[w * WORDBITS + ctz64(bits)] = true;
+    for (Word bits = ~a.data()[w] & mask[w]; bits != 0; bits &= bits - 1) {
+      const size_t j = w * WORDBITS + ctz64(bits);
+      if (bits_geq(C.row(j) + left, above.data(), nw))
+	(*result)[j] = true;
+    }
+  }
 }
 
-unique_ptr<Row> ObsGeq (const Row &a, const Matrix &M) {
-  // selects tuples (rows) above the tuple a
+unique_ptr<Row> ObsGeq (const RowView &a, const MatrixMask &T) {
+  // computes the minimum of the tuples (rows) of T above the tuple a,
+  // on the visible columns of T, using the column index C of T
+  // the rows are split into chunks of words of the column bitmaps,
+  // which are handed to the thread pool
   unique_ptr<Row> P;
-  const size_t msize = M.size();
+  const BitMatrix &C = *T.column_index();
+  const size_t msize = C.num_cols();
+  const size_t nw = C.row_stride();
   if (msize > chunkLIMIT) {
-    size_t nchunks = (msize / chunkLIMIT) + (msize % chunkLIMIT > 0);
-    unique_ptr<Row> chunk[nchunks];
-    vector<thread> chunk_threads;
-    for (size_t i = 0; i < nchunks; ++i)
-      chunk_threads.push_back(std::thread(OGchunk,
-					  ref(a), ref(M), ref(chunk[i]),
-					  i*chunkLIMIT,
-					  min((i+1)*chunkLIMIT, msize)
-					  )
-			      );
-    for (auto &ct : chunk_threads)
-      ct.join();
-    for (size_t i = 0; i < nchunks; ++i)
-      if (chunk[i] != nullptr)
-	P = make_unique<Row>(P == nullptr ? *chunk[i] : Min(*P, *chunk[i]));
+    const size_t chunkw = num_words(chunkLIMIT);
+    size_t nchunks = (nw / chunkw) + (nw % chunkw > 0);
+    P = thread_pool().parallel_reduce
+      (0, nchunks, unique_ptr<Row>(),
+       [&] (const size_t i) {
+	 unique_ptr<Row> chunk;
+	 OGchunk(a, T, chunk, i*chunkw, min((i+1)*chunkw, nw));
+	 return chunk;
+       },
+       [] (unique_ptr<Row> P, unique_ptr<Row> chunk) {
+	 if (chunk == nullptr)
+	   return P;
+	 if (P == nullptr)
+	   return chunk;
+	 return make_unique<Row>(Min(*P, *chunk));
+       });
   } else
-    for (const Row &row : M)
-      if (row >= a)
-	P = make_unique<Row>(P == nullptr ? row : Min(*P, row));
+    OGchunk(a, T, P, 0, nw);
   return P;
 }
 
+// number of blocks of at least grain indices, a few for every thread
+static inline size_t num_blocks (const size_t n, const size_t grain) {
+  return max<size_t>(1, min(n / max<size_t>(grain, 1), 4 * thread_pool().size()));
+}
+
+void parallel_for (const size_t n, const function<void(size_t)> &body, const size_t grain) {
+  const size_t nblocks = num_blocks(n, grain);
+  thread_pool().parallel_for(0, nblocks,
+			     [&] (const size_t b) {
+			       for (size_t i = b * n / nblocks; i < (b+1) * n / nblocks; ++i)
+				 body(i);
+			     });
+}
+
+bool parallel_any (const size_t n, const function<bool(size_t)> &pred, const size_t grain) {
+  // once an index is found, the other blocks stop at their next index
+  atomic<bool> found(false);
+  const size_t nblocks = num_blocks(n, grain);
+  thread_pool().parallel_for(0, nblocks,
+			     [&] (const size_t b) {
+			       for (size_t i = b * n / nblocks; i < (b+1) * n / nblocks && ! found; ++i)
+				 if (pred(i))
+				   found = true;
+			     });
+  return found;
+}
+
 //==================================================================================================
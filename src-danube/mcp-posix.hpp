@@ -29,6 +29,6 @@
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-void OGchunk (const Row &a, const Matrix &M, unique_ptr<Row> &result, size_t left, size_t right);
+void OGchunk (const RowView &a, const MatrixMask &T, unique_ptr<Row> &result, size_t left, size_t right);
 
 //==================================================================================================
@@ -326,7 +326,7 @@ void read_matrix (Group_of_Matrix &matrix) {
     if (arity != temp.size())
       cout << "*** arity discrepancy on line " << numline << endl;
 
-    matrix[test_group].push_back(temp);
+    push_back(matrix[test_group], temp);
   }
   
   if (input != STDIN) {
@@ -341,7 +341,7 @@ void read_matrix (Group_of_Matrix &matrix) {
   }
 }
 
-void print_matrix (Matrix &gmtx) {
+void print_matrix (const BitMatrix &gmtx) {
   cout << "+++ Arity = " << arity << endl;
   cout << "+++ Test Group [" << gmtx.size() << "]:" << endl;
   if (display == yPEEK || display == ySHOW)
@@ -358,7 +358,7 @@ void print_formula (const vector<size_t> &names,
 }
 
 void sat_test (Group_of_Matrix &matrix) {
-  const Matrix gmtx = matrix[test_group];
+  const Matrix gmtx = unpack(matrix[test_group]);
   bool no_id = pivot_file.empty();
   long ctr = SENTINEL;
 
@@ -399,7 +399,7 @@ void sat_test (Group_of_Matrix &matrix) {
   }
 }
 
-void get_pivot (const Matrix &matrix) {
+void get_pivot (const BitMatrix &matrix) {
   if (pivot_file.empty())
     return;
 
@@ -0,0 +1,108 @@
+/**************************************************************************
+ *                                                                        *
+ *                                                                        *
+ *        Multiple Characterization Problem (MCP)                         *
+ *                                                                        *
+ * Author:   Miki Hermann                                                 *
+ * e-mail:   hermann@lix.polytechnique.fr                                 *
+ * Address:  LIX (CNRS UMR 7161), Ecole Polytechnique, France             *
+ *                                                                        *
+ * Author:   Gernot Salzer                                                *
+ * e-mail:   gernot.salzer@tuwien.ac.at                                   *
+ * Address:  Technische Universitaet Wien, Vienna, Austria                *
+ *                                                                        *
+ * Version: all                                                           *
+ *     File:    src-mekong/mcp-bench.cpp                                  *
+ *                                                                        *
+ *      Copyright (c) 2019 - 2025                                         *
+ *                                                                        *
+ * Times insertion and lookup of the rows of a synthetic matrix in a hash *
+ * set, with the row hash before and after it was fixed. Run by           *
+ * make bench                                                             *
+ *                                                                        *
+ **************************************************************************/
+
+#include "mcp-matrix+formula.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+// the former std::hash<Row>: the results of hash_combine were dropped,
+// so every row hashed to 0
+struct dropped_hash {
+  size_t operator()(const Row &r) const noexcept {
+    size_t res = 0;
+    for (size_t i = 0; i < r.size(); ++i) {
+      hash_combine(res, std::hash<integer>{}(r[i]));
+    }
+    return res;
+  }
+};
+
+// equality of the values, inline so that no object file is linked in
+struct same_values {
+  bool operator()(const Row &a, const Row &b) const noexcept {
+    if (a.size() != b.size())
+      return false;
+    for (size_t i = 0; i < a.size(); ++i)
+      if (a[i] != b[i])
+        return false;
+    return true;
+  }
+};
+
+// rows of a random matrix over the domain 0..dmax
+vector<Row> synthetic(size_t nrows, size_t ncols, integer dmax) {
+  mt19937_64 gen(nrows);
+  uniform_int_distribution<unsigned> value(0, dmax);
+  vector<Row> rows;
+  rows.reserve(nrows);
+  for (size_t k = 0; k < nrows; ++k) {
+    Row row(ncols);
+    for (size_t i = 0; i < ncols; ++i)
+      row.set(i, integer(value(gen)));
+    rows.push_back(move(row));
+  }
+  return rows;
+}
+
+// seconds to insert every row and find every row again
+template <typename Hash> double insert_find(const vector<Row> &rows) {
+  const auto start = chrono::steady_clock::now();
+  unordered_set<Row, Hash, same_values> set;
+  for (const Row &row : rows)
+    set.insert(row.clone());
+  size_t found = 0;
+  for (const Row &row : rows)
+    found += set.count(row);
+  const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  if (found != rows.size())
+    cerr << "+++ " << rows.size() - found << " rows not found" << endl;
+  return elapsed.count();
+}
+
+int main() {
+  const size_t ncols = 20;
+  const integer dmax = 15;
+  // the former hash is quadratic, so it stops early
+  const size_t before_limit = 8000;
+
+  cout << "+++ insert and find the rows of a random " << ncols
+       << "-column matrix over 0.." << size_t(dmax) << endl;
+  cout << setw(8) << "rows" << setw(12) << "before" << setw(12) << "after"
+       << endl;
+  for (size_t nrows = 1000; nrows <= 64000; nrows *= 2) {
+    const vector<Row> rows = synthetic(nrows, ncols, dmax);
+    cout << setw(8) << nrows << fixed << setprecision(4);
+    if (nrows <= before_limit)
+      cout << setw(11) << insert_find<dropped_hash>(rows) << "s";
+    else
+      cout << setw(12) << "-";
+    cout << setw(11) << insert_find<std::hash<Row>>(rows) << "s" << endl;
+  }
+}
@@ -139,7 +139,7 @@ namespace bucket {
 
   // Bucket is a formula encoded differently.
   // Test the satisfiability of each clause.
-  bool sat_bucket(const Row &t, const Bucket &B) {
+  bool sat_bucket(RowSpan t, const Bucket &B) {
     for (const auto &b : B) {
       Pattern pattern = b.first;
       for (const Point &point : b.second) {
@@ -70,7 +70,7 @@ namespace bucket {
 
   void insert(const Clause &, Bucket &);
   Formula get_formula(const Bucket &, const size_t &);
-  bool sat_bucket(const Row &, const Bucket &);
+  bool sat_bucket(RowSpan, const Bucket &);
   void print_bucket(const Bucket &);
 
 } // namespace bucket
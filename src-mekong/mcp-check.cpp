@@ -220,7 +220,7 @@ void read_header () {
       vector<string> hds = split(line, ":");
       string name = hds[nOWN];
       Token tk = reverse_string.at(hds[1]);
-      integer dmax = integer(stoull(hds[2]));
+      integer dmax = read_dmax(hds[2], name);
       vector<string> elems;
       move(hds.begin()+3, hds.end(), back_inserter(elems));
       Headline hdl(name, tk, dmax, elems);
@@ -255,7 +255,7 @@ void read_matrix(Group_of_Matrix &matrix) {
       cout << "*** arity discrepancy on line " << numline << endl;
     Row temp;
     for (size_t i = 1; i < nums.size(); ++i) {
-      integer x = integer(stoull(nums.at(i)));
+      integer x = read_value(nums.at(i), numline);
       temp.push_back(x);
     }
     if (matrix.find(group) == matrix.end()) {
@@ -309,7 +309,7 @@ void sat_test(const Group_of_Matrix &matrix, const Formula &formula) {
   for (auto group = matrix.begin(); group != matrix.end(); ++group) {
     const Matrix &gmtx = group->second;
     for (size_t i = 0; i < gmtx.num_rows(); ++i) {
-      const Row &row = gmtx[i];
+      const RowSpan row = gmtx[i];
       if (group->first == suffix) {
         // must satisfy
         if (sat_formula(row, formula))
@@ -427,11 +427,13 @@ void print_result() {
 //////////////////////////////////////////////////////////////////////////////
 
 int main(int argc, char **argv) {
+  read_arg(argc, argv);
+  adjust_and_open();
+  dispatch_width(headerput, argv);
+
   version += "check";
   cerr << "+++ version = " << version << endl;
 
-  read_arg(argc, argv);
-  adjust_and_open();
   print_arg();
   read_formula(names, formula);
   read_header();
@@ -25,6 +25,7 @@
 #include "mcp-common.hpp"
 #include "mcp-matrix+formula.hpp"
 #include <algorithm>
+#include <bit>
 #include <cstdlib>
 #include <fstream>
 #include <functional>
@@ -32,6 +33,7 @@
 #include <limits>
 #include <memory>
 #include <numeric>
+#include <queue>
 #include <random>
 #include <set>
 #include <sstream>
@@ -82,13 +84,15 @@ string input = STDIN;
 string output = STDOUT;
 string headerput    = "";
 string weights      = "";
-bool disjoint = true;
+thread_local bool disjoint = true;
 // int arity = 0;
 
 // int offset          = 0;
 string tpath = "/tmp/"; // directory where the temporary files will be stored
 bool np_fit = false;
 int chunkLIMIT = 4096; // heavily hardware dependent; must be optimized
+unsigned nthreads = 0; // size of the thread pool, 0 = all hardware threads
+unsigned bufferLIMIT = 1024; // MB of output kept in memory by mcp-pthread
 string latex = "";     // file to store latex output
 
 ifstream infile;
@@ -105,7 +109,8 @@ const string closure_strg[] = {"Horn", "dual Horn", "2SAT", "affine",
                                "CNF"};
 const string cooking_strg[] = {"raw", "bleu", "medium", "well done"};
 const string direction_strg[] = {
-  "begin", "end", "optimum", "random", "low cardinality", "high cardinality"};
+  "begin", "end", "optimum", "random", "low cardinality", "high cardinality",
+  "precedence", "block"};
 const string pcl_strg[] = {"Horn", "Horn", "2SAT", "affine", "cnf"};
 const string strategy_strg[] = {"large", "exact"};
 // const string print_strg[]     = {"void",       "clause",     "implication",
@@ -157,6 +162,9 @@ const unordered_map<string, Parameter> param_values = {
   {"--shift", parOFFSET},
   {"--sh", parOFFSET},
   {"--chunk", parCHUNK},
+  {"--th", parTHREADS},
+  {"--threads", parTHREADS},
+  {"--buffer", parBUFFER},
   {"--debug", parDEBUG}
 };
 
@@ -257,6 +265,8 @@ void read_arg (int argc, char *argv[]) {	// reads the input parameters
 	  direction = dRAND;
 	} else if (dir == "precedence" || dir == "prec") {
 	  direction = dPREC;
+	} else if (dir == "block" || dir == "group") {
+	  direction = dBLOCK;
 	} else 
 	  cerr << "+++ unknown direction option " << dir << endl;
       } else
@@ -381,6 +391,30 @@ void read_arg (int argc, char *argv[]) {	// reads the input parameters
       } else
 	cerr << "+++ no chunk limit selected, revert to default" << endl;
       break;
+    case parTHREADS:
+      if (argument + 1 < size_t(argc)) {
+	try {
+	  nthreads = stoul(argv[++argument]);
+	} catch (const invalid_argument &) {
+	  cerr << "+++ " << argv[argument]
+	       << " is not a valid number of threads, revert to default"
+	       << endl;
+	}
+      } else
+	cerr << "+++ no number of threads selected, revert to default" << endl;
+      break;
+    case parBUFFER:
+      if (argument + 1 < size_t(argc)) {
+	try {
+	  bufferLIMIT = stoul(argv[++argument]);
+	} catch (const invalid_argument &) {
+	  cerr << "+++ " << argv[argument]
+	       << " is not a valid buffer limit, revert to default"
+	       << endl;
+	}
+      } else
+	cerr << "+++ no buffer limit selected, revert to default" << endl;
+      break;
     case parDEBUG:
       debug = true;
       break;
@@ -394,7 +428,7 @@ void read_arg (int argc, char *argv[]) {	// reads the input parameters
     std::srand(random_seed);
 }
 
-size_t hamming_distance(const Row &u, const Row &v) {
+size_t hamming_distance(RowSpan u, RowSpan v) {
   // Hamming distance between two tuples
   if (u.size() != v.size())
     return size_t(SENTINEL);
@@ -405,47 +439,114 @@ size_t hamming_distance(const Row &u, const Row &v) {
   return sum;
 }
 
-// is the tuple row in the Horn closure of matrix M?
-// TODO: REWRITE in a zero-copy way in
-// [ ] posix
-// [x] seq
-/*
-  bool InHornClosure(const RowView &row, const Matrix &M) {
-  Matrix P = ObsGeq(row, M);
+// the Horn clause eliminating the negative sample f, read off the minimum
+// of the rows of T above f: x_j < f_j for every f_j > 0, and as head
+// x_j > f_j for the first j where the minimum exceeds f; no head if no row
+// is above f, false if there is no such j, i.e., f is in the Horn closure
+// of T; index is the threshold index of T, T is scanned if it is unbuilt
+bool HornClause(RowSpan f, const Matrix &T, const ThresholdIndex &index,
+                const vector<size_t> &A, Clause &clause) {
+  const size_t arity = T.num_cols();
+  clause.clear();
+  clause.reserve(arity);
+  for (size_t j = 0; j < arity; ++j) {
+    Sign sign = f[j] > 0 ? lneg : lnone;
+    integer val = f[j] > 0 ? f[j] - 1 : 0;
+    clause.push_back(Literal(sign, 0, val));
+  }
 
-  if (P.empty()) {
-  return false;
-  } else if (row == MIN(P)) {
-  return true;
+  vector<char> exceeds;
+  if (index.valid()) {
+    if (!index.minimum_above(f, exceeds))
+      return true;
   } else {
-  return false;
-  }
+    Row MIN;
+    bool any_above = false;
+    for (size_t i = 0; i < T.num_rows(); ++i) {
+      const RowSpan t = T[i];
+      if (t >= f) {
+        if (any_above)
+          MIN.inplace_minimum(t);
+        else {
+          MIN = t.to_row();
+          any_above = true;
+        }
+      }
+    }
+    if (!any_above)
+      return true;
+    exceeds.resize(arity);
+    for (size_t j = 0; j < arity; ++j)
+      exceeds[j] = MIN[j] > f[j];
   }
-*/
 
-// is the intersection of F and of the Horn closure of T empty?
-template <typename M> bool SHCPsolvable(const M &T, const M &F) {
-  for (size_t i = 0; i < F.num_rows(); ++i) {
-    if (InHornClosure(F[i], T))
-      return false;
-  }
-  return true;
+  for (size_t j = 0; j < arity; ++j)
+    if (f[j] < headlines[A[j]].DMAX && exceeds[j]) {
+      clause[j].sign = (Sign)(clause[j].sign | lpos);
+      clause[j].pval = f[j] + 1;
+      return true;
+    }
+  return false;
+}
+
+// the rows of T, without duplicates, that are not the minimum of the
+// other rows above them; they generate the Horn closure of T on every
+// section and give the same minimum of the rows above any tuple
+Matrix meet_irreducible(const Matrix &T) {
+  Matrix R = T.clone();
+  R.sort();
+  R.remove_duplicates();
+  vector<char> irreducible(R.num_rows(), true);
+  parallel_for(
+      R.num_rows(),
+      [&](const size_t i) {
+        const RowSpan r = R[i];
+        Row MIN;
+        bool any_above = false;
+        for (size_t k = 0; k < R.num_rows(); ++k)
+          if (k != i && R[k] >= r) {
+            if (any_above)
+              MIN.inplace_minimum(R[k]);
+            else {
+              MIN = R[k].to_row();
+              any_above = true;
+            }
+          }
+        irreducible[i] = !any_above || !(MIN == r);
+      },
+      16);
+
+  Matrix M;
+  for (size_t i = 0; i < R.num_rows(); ++i)
+    if (irreducible[i])
+      M.add_row(R[i]);
+  return M;
+}
+
+// is f in the Horn closure of T?  with bitmaps if T has a threshold index
+static inline bool in_closure(RowSpan f, const Matrix &T,
+                              const ThresholdIndex &index) {
+  return index.valid() ? index.in_closure(f) : InHornClosure(f, T);
 }
 
-bool SHCPsolvable(const Matrix &T, const Matrix &F) {
-  return SHCPsolvable<Matrix>(T, F);
+static inline bool in_closure(const RowView &f, const MatrixMask &T,
+                              const ThresholdIndex &index) {
+  return index.valid() ? index.in_closure(f, T) : InHornClosure(f, T);
 }
 
-bool SHCPsolvable(const MatrixMask &T, const MatrixMask &F) {
-  return SHCPsolvable<MatrixMask>(T, F);
+// is the intersection of F and of the Horn closure of T empty?
+// the callers reduce T to its meet-irreducible rows (meet_irreducible)
+template <typename M>
+bool SHCPsolvable(const M &T, const M &F, const ThresholdIndex &index) {
+  return !parallel_any(F.num_rows(), [&](const size_t i) {
+    return in_closure(F[i], T, index);
+  });
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
 bool isect_nonempty(const Matrix &T, const Matrix &F) {
-  unordered_set<reference_wrapper<const Row>, std::hash<Row>,
-                std::equal_to<Row>>
-    orig{};
+  unordered_set<RowSpan> orig{};
 
   // insert rowviews into the hashset...
   for (size_t i = 0; i < T.num_rows(); ++i) {
@@ -471,24 +572,23 @@ bool isect_nonempty(const MatrixMask &T, const MatrixMask &F) {
   }
 
   // check for the presence of any row from F in the hashset
-  for (size_t i = 0; i < F.num_rows(); ++i) {
-    if (orig.find(F[i]) != orig.end())
-      return true;
-  }
-
-  return false;
+  return parallel_any(
+    F.num_rows(), [&](const size_t i) { return orig.find(F[i]) != orig.end(); },
+    1024);
 }
 
-bool inadmissible(const Matrix &T, const Matrix &F) {
+bool inadmissible(const Matrix &T, const Matrix &F,
+                  const ThresholdIndex &index) {
   if (closure == clHORN || closure == clDHORN)
-    return !SHCPsolvable(T, F);
+    return !SHCPsolvable(T, F, index);
   else
     return isect_nonempty(T, F);
 }
 
-bool inadmissible(const MatrixMask &T, const MatrixMask &F) {
+bool inadmissible(const MatrixMask &T, const MatrixMask &F,
+                  const ThresholdIndex &index) {
   if (closure == clHORN || closure == clDHORN)
-    return !SHCPsolvable(T, F);
+    return !SHCPsolvable(T, F, index);
   else
     return isect_nonempty(T, F);
 }
@@ -504,21 +604,24 @@ size_t hamming_weight(const vector<bool> &row) {
   return sum;
 }
 
-static inline Mask eliminate(const Matrix &T, const Matrix &F,
+// R is T for the admissibility tests and index its threshold index, see
+// minsect; hiding columns of R leaves the index valid
+static inline Mask eliminate(const Matrix &T, const Matrix &R,
+                             const ThresholdIndex &index, const Matrix &F,
                              const vector<size_t> &coords) {
   const size_t n = T.num_cols();
 
   // boolean mask
   Mask mask(n, true);
-  MatrixMask Tm(T), Fm(F);
+  MatrixMask Tm(R), Fm(F);
 
   for (const size_t &i : coords) {
     mask[i] = false;
     Tm.hide_column(i);
     Fm.hide_column(i);
-    if (inadmissible(Tm, Fm)) {
+    if (inadmissible(Tm, Fm, index)) {
       mask[i] = true;
-      Tm = MatrixMask(T, mask);
+      Tm = MatrixMask(R, mask);
       Fm = MatrixMask(F, mask);
     }
     // we keep at least one coordinate
@@ -543,11 +646,84 @@ static inline Mask eliminate(const Matrix &T, const Matrix &F,
   return mask;
 }
 
+// adds to B a minimal subset X of the coordinates C[0..n-1] such that T
+// and F are admissible on B+X, preferring the first coordinates of C
+// (QuickXplain): the second half of C is reduced while the first half is
+// kept, then the first half while the reduced second half is kept;
+// delta tells whether B is worth testing on its own
+static void quickxplain(const function<bool(const Mask &)> &admissible,
+                        Mask &B, const bool delta, const size_t *C,
+                        const size_t n) {
+  if (delta && admissible(B))
+    return;
+  if (n == 0)
+    return;
+  if (n == 1) {
+    B[C[0]] = true;
+    return;
+  }
+  const size_t k = n / 2;
+  Mask B2 = B;
+  for (size_t i = 0; i < k; ++i)
+    B2[C[i]] = true;
+  quickxplain(admissible, B2, true, C + k, n - k);
+  bool reduced = false; // is X2 = B2 restricted to C[k..n-1] nonempty?
+  for (size_t i = k; i < n; ++i)
+    if (B2[C[i]]) {
+      B[C[i]] = true;
+      reduced = true;
+    }
+  quickxplain(admissible, B, reduced, C, k);
+}
+
+// group testing version of eliminate: drops whole blocks of coordinates
+// at once and bisects only the blocks that cannot be dropped, which needs
+// about k.log(n) admissibility tests for a section of k coordinates
+static inline Mask eliminate_blocks(const Matrix &T, const Matrix &R,
+                                    const ThresholdIndex &index,
+                                    const Matrix &F,
+                                    const vector<size_t> &coords) {
+  const size_t n = T.num_cols();
+
+  // are T and F admissible on the coordinates set in mask?
+  auto admissible = [&](const Mask &mask) {
+    return !inadmissible(MatrixMask(R, mask), MatrixMask(F, mask), index);
+  };
+
+  // the coordinates eliminate would try to remove last are preferred
+  const vector<size_t> keep(coords.crbegin(), coords.crend());
+  Mask mask(n, false);
+  quickxplain(admissible, mask, true, keep.data(), keep.size());
+
+  // we keep at least one coordinate
+  if (hamming_weight(mask) == 0)
+    for (const size_t &j : coords) {
+      unordered_set<integer> Tval, Fval;
+      for (size_t k = 0; k < T.num_rows(); ++k)
+        Tval.insert(T[k][j]);
+      for (size_t k = 0; k < F.num_rows(); ++k)
+        Fval.insert(F[k][j]);
+      if (Fval != Tval) {
+        mask[j] = true;
+        break;
+      }
+    }
+  return mask;
+}
+
 // computes the minimal section for Horn or dual Horn closures
 Mask minsect(const Matrix &T, const Matrix &F) {
   const size_t n = T.num_cols();
 
-  if (inadmissible(T, F)) {
+  // for Horn closures the admissibility tests scan only the
+  // meet-irreducible rows of T, which have the same closure on every
+  // section, through their threshold index
+  const bool horn = closure == clHORN || closure == clDHORN;
+  const Matrix irreducible = horn ? meet_irreducible(T) : Matrix();
+  const Matrix &R = horn ? irreducible : T;
+  const ThresholdIndex index = horn ? ThresholdIndex(R) : ThresholdIndex();
+
+  if (inadmissible(R, F, index)) {
     disjoint = false;
     Mask emptymask(n, false);
     return emptymask;
@@ -560,6 +736,7 @@ Mask minsect(const Matrix &T, const Matrix &F) {
 
   switch (direction) {
   case dBEGIN:
+  case dBLOCK:
     for (size_t i = 0; i < n; ++i)
       coords[i] = n - 1 - i;
     break;
@@ -656,7 +833,9 @@ Mask minsect(const Matrix &T, const Matrix &F) {
     break;
   }
 
-  return eliminate(T, F, coords);
+  if (direction == dBLOCK)
+    return eliminate_blocks(T, R, index, F, coords);
+  return eliminate(T, R, index, F, coords);
 }
 
 // open the file and write the formula in it
@@ -953,24 +1132,79 @@ bool subsumes(const Clause &cla, const Clause &clb) {
   return true;
 }
 
+// the sides of the interval literals of a clause, 2i for x_i <= d and
+// 2i+1 for x_i >= d; a clause subsumes another only if its sides are
+// among those of the other one
+static vector<size_t> literal_sides(const Clause &clause) {
+  vector<size_t> sides;
+  for (size_t i = 0; i < clause.size(); ++i) {
+    if (clause[i].sign & lneg)
+      sides.push_back(2 * i);
+    if (clause[i].sign & lpos)
+      sides.push_back(2 * i + 1);
+  }
+  return sides;
+}
+
 // perform subsumption on clauses of a formula
 // clauses must be sorted by length --- IS GUARANTEED
+// subsumption is transitive, hence a clause goes iff an earlier one
+// subsumes it; the earlier clauses are listed under their rarest side and
+// a 64-bit signature of their sides filters the candidates before the
+// bounds are compared
 Formula subsumption(Formula &formula) {
-  Formula res;
-  // sort_formula not necessary, clauses are GUARANTEED SORTED
-  // sort(formula.begin(), formula.end(), cmp_numlit);
-  // sort_formula(formula, 0, formula.size()-1);
-  while (!formula.empty()) {
-    Clause clause = formula.front();
-    formula.pop_front();
-    auto it = formula.begin();
-    while (it != formula.end())
-      if (subsumes(clause, *it))
-        it = formula.erase(it);
-      else
-        ++it;
-    res.push_back(clause);
+  const size_t m = formula.size();
+  if (m == 0)
+    return formula;
+  const size_t lngt = formula[0].size();
+
+  vector<vector<size_t>> sides(m);
+  vector<uint64_t> signature(m, 0);
+  vector<size_t> frequency(2 * lngt, 0);
+  size_t first_empty = m;
+  for (size_t k = 0; k < m; ++k) {
+    sides[k] = literal_sides(formula[k]);
+    for (const size_t s : sides[k]) {
+      signature[k] |= uint64_t(1) << (s % 64);
+      ++frequency[s];
+    }
+    if (sides[k].empty() && first_empty == m)
+      first_empty = k;
   }
+  vector<vector<size_t>> occurs(2 * lngt);
+  for (size_t k = 0; k < m; ++k)
+    if (!sides[k].empty())
+      occurs[*min_element(sides[k].cbegin(), sides[k].cend(),
+                          [&frequency](const size_t a, const size_t b) {
+                            return frequency[a] < frequency[b];
+                          })]
+          .push_back(k);
+
+  vector<char> removed(m, false);
+  parallel_for(
+      m,
+      [&](const size_t k) {
+        if (first_empty < k) {
+          removed[k] = true;
+          return;
+        }
+        for (const size_t s : sides[k])
+          for (const size_t c : occurs[s]) {
+            if (c >= k)
+              break;
+            if ((signature[c] & ~signature[k]) == 0 &&
+                subsumes(formula[c], formula[k])) {
+              removed[k] = true;
+              return;
+            }
+          }
+      },
+      64);
+
+  Formula res;
+  for (size_t k = 0; k < m; ++k)
+    if (!removed[k])
+      res.push_back(std::move(formula[k]));
   return res;
 }
 
@@ -1042,102 +1276,77 @@ Formula SetCover(const Matrix &Universe, const Formula &SubSets) {
   // perform set cover optimizing the clauses as subsets falsified by tuples as
   // universe Universe = tuples in F
   // SubSets  = clauses of a formula
-  enum Presence { NONE = 0, ABSENT = 1, PRESENT = 2 };
-
-  typedef pair<reference_wrapper<const Row>, reference_wrapper<const Clause>>
-    Falsification;
-  struct falsification_hasher {
-    size_t operator()(const Falsification &f) const noexcept {
-      return hash_combine(hash_combine(std::hash<Row>{}(f.first), 0xff),
-                          std::hash<Clause>{}(f.second));
+  // Row k of the incidence bitmaps holds the tuples falsifying SubSets[k],
+  // and-ed together from the threshold index of Universe.
+  // The greedy choice is lazy: scores only decrease, so a clause whose
+  // score is still exact when it tops the queue is the first best one.
+  const size_t nwords = (Universe.num_rows() + 63) / 64;
+  vector<uint64_t> incidence(SubSets.size() * nwords, 0);
+  const ThresholdIndex index(Universe);
+  parallel_for(SubSets.size(), [&](const size_t k) {
+    uint64_t *falsified = &incidence[k * nwords];
+    if (index.valid()) {
+      index.falsifying(SubSets[k], falsified);
+      return;
     }
+    for (size_t i = 0; i < Universe.num_rows(); ++i)
+      if (!sat_clause(Universe[i], SubSets[k]))
+        falsified[i / 64] |= uint64_t(1) << (i % 64);
+  });
+
+  // a clause occurring several times in SubSets scores several times
+  unordered_map<reference_wrapper<const Clause>, size_t, std::hash<Clause>,
+                std::equal_to<Clause>>
+    occurrences;
+  for (const Clause &clause : SubSets)
+    ++occurrences[clause];
+  vector<size_t> multiplicity(SubSets.size());
+  for (size_t k = 0; k < SubSets.size(); ++k)
+    multiplicity[k] = occurrences.at(SubSets[k]);
+
+  // tuples still active == not yet falsified
+  vector<uint64_t> active(nwords, ~uint64_t(0));
+  if (Universe.num_rows() % 64 != 0)
+    active.back() = (uint64_t(1) << (Universe.num_rows() % 64)) - 1;
+  size_t remaining = Universe.num_rows();
+  auto score = [&](const size_t k) {
+    const uint64_t *falsified = &incidence[k * nwords];
+    size_t count = 0;
+    for (size_t w = 0; w < nwords; ++w)
+      count += popcount(falsified[w] & active[w]);
+    return multiplicity[k] * count;
   };
-  struct falsification_eq {
-    bool operator()(const Falsification &a,
-                    const Falsification &b) const noexcept {
-      return a.first.get() == b.first.get() && a.second.get() == b.second.get();
-    }
+
+  // highest score first, on a tie the clause coming first in SubSets
+  typedef pair<size_t, size_t> Entry; // score and index of a clause
+  auto lower = [](const Entry &a, const Entry &b) {
+    return a.first < b.first || (a.first == b.first && a.second > b.second);
   };
+  priority_queue<Entry, vector<Entry>, decltype(lower)> queue(lower);
+  vector<size_t> initial(SubSets.size());
+  parallel_for(SubSets.size(), [&](const size_t k) { initial[k] = score(k); });
+  for (size_t k = 0; k < SubSets.size(); ++k)
+    if (initial[k] > 0)
+      queue.emplace(initial[k], k);
 
-  // Incidence matrix indicating which tuple (row) falsifies which clause
-  unordered_map<Falsification, Presence, falsification_hasher, falsification_eq>
-    incidence;
-  vector<size_t> R; // tuples still active == not yet falsified
   Formula selected; // selected clauses for falsification
-
-  for (size_t i = 0; i < Universe.num_rows(); ++i) {
-    R.push_back(i);
-
-    const Row &tuple = Universe[i];
-    for (const Clause &clause : SubSets)
-      incidence[make_pair(cref(tuple), cref(clause))] =
-	sat_clause(tuple, clause) ? ABSENT : PRESENT;
-  }
-
-  // perform set cover
-  while (!R.empty()) {
-    cerr << "\r" << R.size() << flush;
-
-    // How many tuples does the clause falsify (intersect)?
-    unordered_map<reference_wrapper<const Clause>, size_t, std::hash<Clause>>
-      intersect;
-    for (const Clause &clause : SubSets)
-      intersect[clause] = 0;
-
-    for (const Clause &clause : SubSets) {
-#pragma omp parallel for
-      for (size_t i : R) {
-        const Row &tuple = Universe[i];
-        if (incidence[make_pair(cref(tuple), cref(clause))] == PRESENT) {
-          ++intersect[clause];
-        }
-      }
-    }
-
-    struct maxclause {
-      size_t maxw;
-      const Clause *maxset;
-
-      static maxclause max(maxclause a, maxclause b) {
-        return a.maxw > b.maxw ? a : b;
-      }
-    };
-
-#pragma omp declare reduction(maxVal:maxclause : omp_out =	\
-			      maxclause::max(omp_out, omp_in))
-
-    maxclause m = {.maxw = 0, .maxset = &SubSets[0]};
-
-#pragma omp parallel for reduction(maxVal : m)
-    for (const Clause &clause : SubSets) {
-      if (intersect[clause] > m.maxw) {
-        m.maxw = intersect[clause];
-        m.maxset = &clause;
-      }
+  while (!queue.empty()) {
+    const size_t k = queue.top().second;
+    const size_t stale = queue.top().first;
+    queue.pop();
+    const size_t fresh = score(k);
+    if (fresh == 0)
+      continue;
+    if (fresh < stale) {
+      queue.emplace(fresh, k);
+      continue;
     }
-
-    size_t maxw = m.maxw;
-    // cannot be invalidated: SubSets is immutable.
-    const Clause *maxset = m.maxset;
-
-    if (maxw == 0)
-      break;
-    selected.push_back(*maxset);
-
-    size_t i = 0;
-    while (i < R.size()) {
-      const Row &tuple = Universe[R[i]];
-      if (incidence[make_pair(cref(tuple), cref(*maxset))] == PRESENT) {
-        for (const Clause &clause : SubSets) {
-          incidence[make_pair(cref(tuple), cref(clause))] = ABSENT;
-        }
-        if (i != R.size() - 1) {
-          swap(R[i], R[R.size() - 1]);
-        }
-        R.resize(R.size() - 1);
-      } else {
-        ++i;
-      }
+    cerr << "\r" << remaining << flush;
+    selected.push_back(SubSets[k]);
+    const uint64_t *falsified = &incidence[k * nwords];
+    for (size_t w = 0; w < nwords; ++w) {
+      remaining -= popcount(falsified[w] & active[w]);
+      active[w] &= ~falsified[w];
     }
   }
 
@@ -1172,12 +1381,12 @@ void predecessor(const Matrix &R) {
   pred[R[0].clone()] = size_t(SENTINEL);
   // pred.insert({R[0].clone(), SENTINEL});
 
-  auto p = cref(R[0]);
+  RowSpan p = R[0];
   for (size_t i = 1; i < R.num_rows(); ++i) {
-    const Row &m = R[i];
+    const RowSpan m = R[i];
     size_t j = 0;
     for (size_t k = 0; k < m.size(); ++k)
-      if (m[k] == p.get()[k])
+      if (m[k] == p[k])
         j++;
       else
         break;
@@ -1190,12 +1399,12 @@ void successor(const Matrix &R) {
   // sucessor function of Zanuttini's algorithm
   // R must be lexicographically sorted
   succ.clear();
-  auto m = cref(R[0]);
+  RowSpan m = R[0];
   for (size_t i = 1; i < R.num_rows(); ++i) {
-    const Row &s = R[i];
+    const RowSpan s = R[i];
     size_t j = 0;
-    for (size_t k = 0; k < m.get().size(); ++k)
-      if (m.get()[k] == s[k])
+    for (size_t k = 0; k < m.size(); ++k)
+      if (m[k] == s[k])
         j++;
       else
         break;
@@ -1208,12 +1417,12 @@ void successor(const Matrix &R) {
 void simsim(const Matrix &R) { // sim array of Zanuttini's algorithm
   sim.clear();
   for (size_t i = 0; i < R.num_rows(); ++i) {
-    const Row &mm = R[i];
+    const RowSpan mm = R[i];
     const vector<size_t> dummy(mm.size(), size_t(SENTINEL));
     sim[mm.clone()] = std::move(dummy);
 
     for (size_t k = 0; k < R.num_rows(); ++k) {
-      const Row &m1m = R[k];
+      const RowSpan m1m = R[k];
       if (mm == m1m)
         continue;
       size_t j0 = 0;
@@ -1230,7 +1439,7 @@ void simsim(const Matrix &R) { // sim array of Zanuttini's algorithm
 }
 
 // TODO: what the frick
-Clause hext(const Row &m, const int &j) {
+Clause hext(RowSpan m, const int &j) {
   // generate clauses with Zanuttini's algorithm
   Clause clause(m.size(), Literal::none());
   /*
@@ -1313,7 +1522,7 @@ Formula learnHornExact(const Matrix &T, const vector<size_t> &A) {
 
   const size_t lngt = T.num_cols();
   if (T.num_rows() == 1) { // T has only one row / tuple
-    const Row &t = T[0];
+    const RowSpan t = T[0];
     for (size_t i = 0; i < lngt; ++i) {
       Clause clause(lngt, Literal::none());
       clause[i] = Literal::pos(t[i]);
@@ -1334,7 +1543,7 @@ Formula learnHornExact(const Matrix &T, const vector<size_t> &A) {
   simsim(T);
 
   for (size_t i = 0; i < T.num_rows(); ++i) {
-  const Row &m = T[i];
+  const RowSpan m = T[i];
   for (int j = 0; j < lngt; ++j)
   if ((j > pred[m] && m[j] == true) || (j > succ[m] && m[j] == false))
   H.push_back(hext(m, j));
@@ -1351,7 +1560,7 @@ Formula learnHornExact(const Matrix &T, const vector<size_t> &A) {
 Formula learnCNFlarge(const Matrix &F, const vector<size_t> &A) {
   Formula formula;
   for (size_t j = 0; j < F.num_rows(); ++j) {
-    const Row &row = F[j];
+    const RowSpan row = F[j];
     Clause clause(row.size());
     // for (bool bit : row)
     for (size_t i = 0; i < row.size(); ++i) {
@@ -1378,7 +1587,7 @@ Formula learnCNFlarge(const Matrix &F, const vector<size_t> &A) {
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
 // UNSAFE if m1 == m2
-size_t fork(const Row &m1, const Row &m2) {
+size_t fork(RowSpan m1, RowSpan m2) {
   size_t i = 0;
   // we can guarantee that always m1 != m2, therefore
   // we can drop i < m1.size()
@@ -1397,20 +1606,20 @@ deque<size_t> fork(const Matrix &M) {
 }
 
 /*
-  Clause negTerm(const Row &m, const int &i) {
+  Clause negTerm(RowSpan m, const int &i) {
   Clause clause(m.size(), Literal::none());
   for (int j = 0; j < i; ++j)
   clause[j] = m[j] == false ? lpos : lneg;
   return clause;
   }
 
-  Clause negLeft(const Row &m, const int &i) {
+  Clause negLeft(RowSpan m, const int &i) {
   Clause clause = negTerm(m, i);
   clause[i] = lpos; // negLT
   return clause;
   }
 
-  Clause negRight(const Row &m, const int &i) {
+  Clause negRight(RowSpan m, const int &i) {
   Clause clause = negTerm(m, i);
   clause[i] = lneg; // negGT
   return clause;
@@ -1445,9 +1654,9 @@ Formula learnCNFexact(const Matrix &T) {
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-// swap the polarity of values in a tuple
-void polswap_row(Row &row) {
-  for (size_t i = 0; i < row.size(); ++i) {
+// swap the polarity of the values of a tuple
+void polswap_row(integer *row, const size_t arity) {
+  for (size_t i = 0; i < arity; ++i) {
     row[i] = headlines[i].DMAX - row[i];
   }
 }
@@ -1455,7 +1664,7 @@ void polswap_row(Row &row) {
 // swap polarity of every tuple in a matrix
 void polswap_matrix(Matrix &A) {
   for (size_t i = 0; i < A.num_rows(); ++i) {
-    polswap_row(A[i]);
+    polswap_row(A.row_values(i), A.num_cols());
   }
 }
 
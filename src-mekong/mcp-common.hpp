@@ -24,8 +24,10 @@
 
 #pragma once
 
+#include "mcp-index.hpp"
 #include "mcp-matrix+formula.hpp"
 #include <deque>
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -61,7 +63,9 @@ enum Parameter : size_t {parERROR = 0,
 			 parMATRIX = 16,
 			 parOFFSET = 17,
 			 parCHUNK = 18,
-			 parDEBUG = 19};
+			 parTHREADS = 19,
+			 parBUFFER = 20,
+			 parDEBUG = 21};
 
 enum Closure : char {
   clHORN = 0,
@@ -78,7 +82,8 @@ enum Direction : char {
   dRAND = 3,
   dLOWSCORE = 4,
   dHIGHSCORE = 5,
-  dPREC = 6
+  dPREC = 6,
+  dBLOCK = 7
 };
 // enum Print     {pVOID   = 0, pCLAUSE = 1, pIMPL        = 2, pMIX       = 3,
 // pDIMACS   = 4};
@@ -105,13 +110,15 @@ extern std::string input;
 extern std::string output;
 extern std::string headerput;
 extern std::string weights;
-extern bool disjoint;
+extern thread_local bool disjoint;	// set by minsect in the thread calling it
 // extern int arity;
 
 // extern int offset;
 extern std::string tpath; // directory where the temporary files will be stored
 extern bool np_fit;
 extern int chunkLIMIT; // heavily hardware dependent; must be optimized
+extern unsigned nthreads; // size of the thread pool, 0 = all hardware threads
+extern unsigned bufferLIMIT; // MB of output kept in memory by mcp-pthread
 extern Arch arch;
 extern std::string latex; // file to store latex output
 
@@ -134,16 +141,30 @@ extern const std::string arch_strg[];
 //--------------------------------------------------------------------------------------------------
 
 void read_arg(int argc, char *argv[]);
-size_t hamming_distance(const Row &u, const Row &v);
+size_t hamming_distance(RowSpan u, RowSpan v);
 
 // ostream& operator<< (ostream &output, const Row &row);
 // ostream& operator<< (ostream &output, const Matrix &M);
 
 bool InHornClosure(const RowView &a, const MatrixMask &M);
-bool InHornClosure(const Row &a, const Matrix &M);
-
-bool inadmissible(const Matrix &T, const Matrix &F);
-bool inadmissible(const MatrixMask &T, const MatrixMask &F);
+bool InHornClosure(RowSpan a, const Matrix &M);
+bool HornClause(RowSpan f, const Matrix &T, const ThresholdIndex &index,
+                const std::vector<size_t> &A, Clause &clause);
+
+// loop over [0, n) in blocks of at least grain indices:
+// sequential in mcp-seq, on the thread pool in mcp-pthread
+void parallel_for(const size_t n, const std::function<void(size_t)> &body,
+                  const size_t grain = 1);
+// is pred true for some index in [0, n)?  stops at the first one found
+bool parallel_any(const size_t n, const std::function<bool(size_t)> &pred,
+                  const size_t grain = 1);
+
+// index is the threshold index of T, resp. of the matrix under the mask
+// of T, or an unbuilt one
+bool inadmissible(const Matrix &T, const Matrix &F,
+                  const ThresholdIndex &index);
+bool inadmissible(const MatrixMask &T, const MatrixMask &F,
+                  const ThresholdIndex &index);
 
 size_t hamming_weight(const std::vector<bool> &row);
 
@@ -152,6 +173,7 @@ Mask minsect(const Matrix &T, const Matrix &F);
 bool satisfied_by(const Clause &clause, const Matrix &T);
 
 void restrict(const std::vector<bool> &sect, Matrix &A);
+Matrix meet_irreducible(const Matrix &T);
 
 Matrix HornClosure(const Matrix &M);
 
@@ -0,0 +1,206 @@
+/**************************************************************************
+ *                                                                        *
+ *                                                                        *
+ *        Multiple Characterization Problem (MCP)                         *
+ *                                                                        *
+ * Author:   Miki Hermann                                                 *
+ * e-mail:   hermann@lix.polytechnique.fr                                 *
+ * Address:  LIX (CNRS UMR 7161), Ecole Polytechnique, France             *
+ *                                                                        *
+ * Author:   Gernot Salzer                                                *
+ * e-mail:   gernot.salzer@tuwien.ac.at                                   *
+ * Address:  Technische Universitaet Wien, Vienna, Austria                *
+ *                                                                        *
+ * Version: all                                                           *
+ *     File:    src-mekong/mcp-index.cpp                                  *
+ *                                                                        *
+ *      Copyright (c) 2019 - 2025                                         *
+ *                                                                        *
+ **************************************************************************/
+
+#include "mcp-index.hpp"
+#include <algorithm>
+
+using namespace std;
+
+// 64 MB of bitmaps at most; beyond, the domains are not small enough
+static constexpr size_t WORDLIMIT = size_t(1) << 23;
+
+// the scratch bitmaps of the queries, one set per thread
+static thread_local vector<uint64_t> scratch;
+
+ThresholdIndex::ThresholdIndex(const Matrix &M)
+  : nrows(M.num_rows()), nwords((M.num_rows() + 63) / 64) {
+  const size_t arity = M.num_cols();
+  values.resize(arity);
+  size_t total = 0;
+  for (size_t j = 0; j < arity; ++j) {
+    vector<integer> &vals = values[j];
+    vals.reserve(nrows);
+    for (size_t i = 0; i < nrows; ++i)
+      vals.push_back(M.get(i, j));
+    sort(vals.begin(), vals.end());
+    vals.erase(unique(vals.begin(), vals.end()), vals.end());
+    vals.shrink_to_fit();
+    total += vals.size() * nwords;
+    if (total > WORDLIMIT) {
+      values.clear();
+      return;
+    }
+  }
+
+  everything.assign(nwords, ~uint64_t(0));
+  if (nrows % 64 != 0)
+    everything.back() = (uint64_t(1) << (nrows % 64)) - 1;
+
+  // every row sets its bit in the bitmap of its own value, then each
+  // bitmap collects the ones of the higher values
+  bitmaps.resize(arity);
+  for (size_t j = 0; j < arity; ++j) {
+    const vector<integer> &vals = values[j];
+    vector<uint64_t> &b = bitmaps[j];
+    b.assign(vals.size() * nwords, 0);
+    for (size_t i = 0; i < nrows; ++i) {
+      const size_t k =
+        lower_bound(vals.begin(), vals.end(), M.get(i, j)) - vals.begin();
+      b[k * nwords + i / 64] |= uint64_t(1) << (i % 64);
+    }
+    for (size_t k = vals.size(); k-- > 1;)
+      for (size_t w = 0; w < nwords; ++w)
+        b[(k - 1) * nwords + w] |= b[k * nwords + w];
+  }
+  indexed = true;
+}
+
+template <typename R>
+bool ThresholdIndex::rows_above(const R &tuple, const permutation *cols,
+                                uint64_t *acc) const {
+  if (nrows == 0)
+    return false;
+  copy(everything.begin(), everything.end(), acc);
+  for (size_t c = 0; c < tuple.size(); ++c) {
+    const size_t j = cols == nullptr ? c : (*cols)[c];
+    const vector<integer> &vals = values[j];
+    const size_t k =
+      lower_bound(vals.begin(), vals.end(), tuple[c]) - vals.begin();
+    if (k == vals.size())
+      return false;
+    if (k == 0)
+      continue;
+    const uint64_t *b = bitmap(j, k);
+    uint64_t any = 0;
+    for (size_t w = 0; w < nwords; ++w)
+      any |= acc[w] &= b[w];
+    if (any == 0)
+      return false;
+  }
+  return true;
+}
+
+// the tuple is the minimum of the rows above it iff every column has a
+// row above it with the same value there, i.e., not all of them greater
+template <typename R>
+bool ThresholdIndex::in_closure(const R &tuple, const permutation *cols) const {
+  scratch.resize(nwords);
+  uint64_t *acc = scratch.data();
+  if (!rows_above(tuple, cols, acc))
+    return false;
+  for (size_t c = 0; c < tuple.size(); ++c) {
+    const size_t j = cols == nullptr ? c : (*cols)[c];
+    const vector<integer> &vals = values[j];
+    const size_t k =
+      upper_bound(vals.begin(), vals.end(), tuple[c]) - vals.begin();
+    if (k == vals.size())
+      continue;
+    const uint64_t *b = bitmap(j, k);
+    uint64_t any = 0;
+    for (size_t w = 0; w < nwords && any == 0; ++w)
+      any = acc[w] & ~b[w];
+    if (any == 0)
+      return false;
+  }
+  return true;
+}
+
+bool ThresholdIndex::in_closure(RowSpan tuple) const {
+  return in_closure(tuple, nullptr);
+}
+
+bool ThresholdIndex::in_closure(const RowView &tuple,
+                                const MatrixMask &M) const {
+  return in_closure(tuple, &M.columns());
+}
+
+bool ThresholdIndex::minimum_above(RowSpan tuple, vector<char> &exceeds) const {
+  scratch.resize(nwords);
+  uint64_t *acc = scratch.data();
+  if (!rows_above(tuple, nullptr, acc))
+    return false;
+  exceeds.assign(tuple.size(), true);
+  for (size_t j = 0; j < tuple.size(); ++j) {
+    const vector<integer> &vals = values[j];
+    const size_t k =
+      upper_bound(vals.begin(), vals.end(), tuple[j]) - vals.begin();
+    if (k == vals.size()) {
+      exceeds[j] = false;
+      continue;
+    }
+    const uint64_t *b = bitmap(j, k);
+    for (size_t w = 0; w < nwords; ++w)
+      if ((acc[w] & ~b[w]) != 0) {
+        exceeds[j] = false;
+        break;
+      }
+  }
+  return true;
+}
+
+// a row falsifies x_j <= nval if x_j is above nval, x_j >= pval if it is
+// not at least pval, and the clause if it falsifies all its literals;
+// falsified is cleared if no row falsifies the clause
+bool ThresholdIndex::falsifying(const Clause &clause,
+                                uint64_t *falsified) const {
+  auto none = [&]() {
+    fill(falsified, falsified + nwords, 0);
+    return false;
+  };
+  if (nrows == 0)
+    return false;
+  copy(everything.begin(), everything.end(), falsified);
+  for (size_t j = 0; j < min(clause.size(), values.size()); ++j) {
+    const Literal &lit = clause[j];
+    const vector<integer> &vals = values[j];
+    if (lit.sign & lneg) {
+      const size_t k =
+        upper_bound(vals.begin(), vals.end(), lit.nval) - vals.begin();
+      if (k == vals.size())
+        return none();
+      const uint64_t *b = bitmap(j, k);
+      uint64_t any = 0;
+      for (size_t w = 0; w < nwords; ++w)
+        any |= falsified[w] &= b[w];
+      if (any == 0)
+        return false;
+    }
+    if (lit.sign & lpos) {
+      const size_t k =
+        lower_bound(vals.begin(), vals.end(), lit.pval) - vals.begin();
+      if (k == 0)
+        return none();
+      if (k == vals.size())
+        continue;
+      const uint64_t *b = bitmap(j, k);
+      uint64_t any = 0;
+      for (size_t w = 0; w < nwords; ++w)
+        any |= falsified[w] &= ~b[w];
+      if (any == 0)
+        return false;
+    }
+  }
+  return true;
+}
+
+bool ThresholdIndex::satisfied(const Clause &clause) const {
+  scratch.resize(nwords);
+  return !falsifying(clause, scratch.data());
+}
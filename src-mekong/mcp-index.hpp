@@ -0,0 +1,86 @@
+/**************************************************************************
+ *                                                                        *
+ *                                                                        *
+ *        Multiple Characterization Problem (MCP)                         *
+ *                                                                        *
+ * Author:   Miki Hermann                                                 *
+ * e-mail:   hermann@lix.polytechnique.fr                                 *
+ * Address:  LIX (CNRS UMR 7161), Ecole Polytechnique, France             *
+ *                                                                        *
+ * Author:   Gernot Salzer                                                *
+ * e-mail:   gernot.salzer@tuwien.ac.at                                   *
+ * Address:  Technische Universitaet Wien, Vienna, Austria                *
+ *                                                                        *
+ * Version: all                                                           *
+ *     File:    src-mekong/mcp-index.hpp                                  *
+ *                                                                        *
+ *      Copyright (c) 2019 - 2025                                         *
+ *                                                                        *
+ * Threshold index of a matrix: for every column j and every value v      *
+ * occurring in it, the bitmap of the rows with M[i][j] >= v.  A tuple is *
+ * compared with all rows of the matrix by and-ing one bitmap per column, *
+ * 64 rows per machine word.                                              *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mcp-matrix+formula.hpp"
+
+class ThresholdIndex {
+public:
+  using permutation = RowView::permutation;
+
+private:
+  size_t nrows = 0;
+  size_t nwords = 0;
+  bool indexed = false;
+  // all rows of the matrix, the padding bits of the last word are 0
+  std::vector<uint64_t> everything;
+  // the distinct values of every column in increasing order
+  std::vector<std::vector<integer>> values;
+  // bitmaps[j][k * nwords ...] are the rows whose column j is at least
+  // values[j][k]; bitmap 0 of a column are all rows
+  std::vector<std::vector<uint64_t>> bitmaps;
+
+  // rows with column j at least the k-th distinct value
+  inline const uint64_t *bitmap(size_t j, size_t k) const {
+    return bitmaps[j].data() + k * nwords;
+  }
+  // the rows of the matrix above the tuple on the columns cols, in acc;
+  // false if there is none
+  template <typename R>
+  bool rows_above(const R &tuple, const permutation *cols,
+                  uint64_t *acc) const;
+  template <typename R>
+  bool in_closure(const R &tuple, const permutation *cols) const;
+
+public:
+  ThresholdIndex() = default;
+  // the index is not built if its bitmaps would exceed WORDLIMIT words,
+  // the callers scan the matrix instead
+  explicit ThresholdIndex(const Matrix &M);
+
+  // was the index built?
+  inline bool valid() const { return indexed; }
+  inline size_t num_rows() const { return nrows; }
+  // words of a bitmap of rows
+  inline size_t num_words() const { return nwords; }
+
+  // is the tuple in the Horn closure of the matrix, i.e., the minimum of
+  // the rows above it?
+  bool in_closure(RowSpan tuple) const;
+  // the same on the visible columns of a masked view of the matrix,
+  // hiding a column needs no update of the index
+  bool in_closure(const RowView &tuple, const MatrixMask &M) const;
+  // the columns j where the minimum of the rows above the tuple exceeds
+  // tuple[j], see HornClause; false if no row is above the tuple
+  bool minimum_above(RowSpan tuple, std::vector<char> &exceeds) const;
+  // the rows falsifying the clause, in falsified; false if there is none
+  bool falsifying(const Clause &clause, uint64_t *falsified) const;
+  // is the clause satisfied by all rows of the matrix?
+  bool satisfied(const Clause &clause) const;
+};
@@ -23,6 +23,7 @@
  **************************************************************************/
 
 #include <cstdint>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 // #include <sstream>
@@ -30,10 +31,12 @@
 #include "mcp-matrix+formula.hpp"
 #include <algorithm>
 #include <limits>
+#include <numeric>
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include <cmath>
+#include <unistd.h>
 #include "mcp-trans.hpp"
 
 using namespace std;
@@ -73,68 +76,54 @@ bool nosection = false;
 
 //------------------------------------------------------------------------------
 
-void Row::inplace_minimum(const Row &other) & {
+void Row::inplace_minimum(RowSpan other) & {
+  invalidate();
   for (size_t i = 0; i < other.size(); ++i) {
-    if (operator[](i) > other[i]) {
-      operator[](i) = other[i];
+    if (data[i] > other[i]) {
+      data[i] = other[i];
     }
   }
 }
 
 void Row::inplace_minimum(const RowView &other) & {
+  invalidate();
   for (size_t i = 0; i < other.size(); ++i) {
-    if (operator[](i) > other[i]) {
-      operator[](i) = other[i];
+    if (data[i] > other[i]) {
+      data[i] = other[i];
     }
   }
 }
 
-void Row::restrict(const Mask &m) {
-  size_t col = 0;
-  for (size_t j = 0; j < m.size(); ++j) {
-    if (m[j]) {
-      // invariant: col <= j
-      data[col] = data[j];
-      col++;
-    }
-  }
-  data.resize(col);
-}
-
-bool Row::operator>=(const Row &rhs) const {
-  if (rhs.size() != size())
+bool operator>=(RowSpan lhs, RowSpan rhs) {
+  if (rhs.size() != lhs.size())
     return false;
 
   for (size_t i = 0; i < rhs.size(); ++i) {
-    if (rhs[i] > operator[](i))
+    if (rhs[i] > lhs[i])
       return false;
   }
   return true;
 }
 
-bool Row::operator>(const Row &rhs) const {
-  if (rhs.size() != size())
+bool operator>(RowSpan lhs, RowSpan rhs) {
+  if (rhs.size() != lhs.size())
     return false;
 
   for (size_t i = 0; i < rhs.size(); ++i) {
-    if (rhs[i] >= operator[](i))
+    if (rhs[i] >= lhs[i])
       return false;
   }
   return true;
 }
 
-bool Row::operator==(const Row &rhs) const {
-  if (rhs.size() != size())
+bool operator==(RowSpan lhs, RowSpan rhs) {
+  if (rhs.size() != lhs.size())
     return false;
 
-  for (size_t i = 0; i < rhs.size(); ++i) {
-    if (rhs[i] != operator[](i))
-      return false;
-  }
-  return true;
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-double Row::zscore () const {
+double RowSpan::zscore () const {
   double mean = 0.0;
   for (size_t i = 0; i < this->size(); ++i)
     mean += 1.0 * (*this)[i];;
@@ -165,7 +154,7 @@ bool RowView::operator>=(const RowView &rhs) const {
   return true;
 }
 
-bool RowView::operator>=(const Row &rhs) const {
+bool RowView::operator>=(RowSpan rhs) const {
   if (rhs.size() != size())
     return false;
 
@@ -187,7 +176,7 @@ bool RowView::operator>(const RowView &rhs) const {
   return true;
 }
 
-bool RowView::operator>(const Row &rhs) const {
+bool RowView::operator>(RowSpan rhs) const {
   if (rhs.size() != size())
     return false;
 
@@ -209,7 +198,7 @@ bool RowView::operator==(const RowView &rhs) const {
   return true;
 }
 
-bool RowView::operator==(const Row &rhs) const {
+bool RowView::operator==(RowSpan rhs) const {
   if (rhs.size() != size())
     return false;
 
@@ -223,78 +212,169 @@ bool RowView::operator==(const Row &rhs) const {
 Row RowView::to_row() const {
   Row res(cols.size());
   for (size_t i = 0; i < cols.size(); ++i) {
-    res[i] = data[cols[i]];
+    res.set(i, data[cols[i]]);
   }
   return res;
 }
 
+void Matrix::add_row(RowSpan new_row) & {
+  if (nrows == 0) {
+    ncols = new_row.size();
+    values.clear();
+    values.reserve(std::max<size_t>(reserved, 1) * ncols);
+    reserved = 0;
+  } else if (new_row.size() != ncols) {
+    cerr << "+++ row of " << new_row.size()
+         << " values added to a matrix of " << ncols << " columns" << endl;
+    exit(2);
+  }
+  // the row may be one of ours, which the resize can move
+  const integer *from = new_row.data();
+  const bool own = from >= values.data() && from < values.data() + values.size();
+  const size_t offset = own ? size_t(from - values.data()) : 0;
+  values.resize(values.size() + ncols);
+  if (own)
+    from = values.data() + offset;
+  std::copy(from, from + ncols, values.end() - ncols);
+  ++nrows;
+}
+
 void Matrix::delete_row(size_t index) {
-  // swap and forget last row
+  // overwrite with and forget the last row
   size_t last = num_rows() - 1;
 
   if (index != last)
-    std::swap(data[index], data[last]);
-  data.resize(last);
+    std::copy(values.begin() + last * ncols, values.end(),
+              values.begin() + index * ncols);
+  values.resize(last * ncols);
+  nrows = last;
 }
 
 Matrix MatrixMask::to_matrix() const & {
-  vector<Row> data;
-  data.reserve(num_rows());
-
+  Matrix res;
+  res.ncols = num_cols();
+  res.nrows = num_rows();
+  res.values.resize(res.nrows * res.ncols);
+  integer *out = res.values.data();
   for (size_t i = 0; i < num_rows(); ++i) {
-    data.push_back(operator[](i).to_row());
+    const RowSpan row = matrix.get()[i];
+    for (const size_t j : cols)
+      *out++ = row[j];
   }
-
-  return Matrix(std::move(data));
+  return res;
 }
 
 Matrix Matrix::transpose() const & {
   Matrix tr;
-  for (size_t col = 0; col < this->num_cols(); ++col) {
-    Row temp(this->num_rows());
-    for (size_t row = 0; row < this->num_rows(); ++row)
-      temp[row] = (*this)[row][col];
-    tr.add_row(std::move(temp));
-  }
+  tr.ncols = nrows;
+  tr.nrows = num_cols();
+  tr.values.resize(values.size());
+  for (size_t row = 0; row < nrows; ++row)
+    for (size_t col = 0; col < ncols; ++col)
+      tr.values[col * nrows + row] = values[row * ncols + col];
   return tr;
 }
 
+// the kept values of row i move to i * (new ncols), never after where row
+// i was read from, and rows are compacted in order, so the buffer is
+// rewritten in place in one pass
 void Matrix::restrict(const Mask &m) {
-  // can be parallelised easily
-  // #pragma omp parallel for
-  for (size_t i = 0; i < num_rows(); ++i) {
-    data[i].restrict(m);
-  }
-}
-
-size_t partition_matrix(Matrix &mtx, size_t low, size_t high) {
-  const Row &pivot = mtx[high];
-  size_t p_index = low;
-
-  for (size_t i = low; i < high; i++) {
-    if (mtx[i].total_order(pivot) <= 0) {
-      std::swap(mtx[i], mtx[p_index]);
-      p_index++;
+  vector<size_t> kept;
+  for (size_t j = 0; j < m.size(); ++j)
+    if (m[j])
+      kept.push_back(j);
+  integer *out = values.data();
+  for (size_t i = 0; i < nrows; ++i) {
+    const integer *row = values.data() + i * ncols;
+    for (const size_t j : kept)
+      *out++ = row[j];
+  }
+  ncols = kept.size();
+  values.resize(nrows * ncols);
+}
+
+// buckets smaller than this are left to introsort
+static constexpr size_t RADIXCUT = 64;
+
+// MSD radix sort of perm[lo, hi) by the columns col, col+1, ... of the rows:
+// a counting sort per column over the values of the bucket, introsort on
+// small buckets and on value ranges wider than the bucket
+static void radix_sort(const Matrix &mtx, vector<size_t> &perm,
+                       vector<size_t> &temp, size_t lo, size_t hi,
+                       size_t col) {
+  const auto less = [&mtx](const size_t a, const size_t b) {
+    return mtx[a].total_order(mtx[b]) < 0;
+  };
+  for (; col < mtx.num_cols(); ++col) {
+    if (hi - lo < RADIXCUT) {
+      std::sort(perm.begin() + lo, perm.begin() + hi, less);
+      return;
+    }
+    integer low = numeric_limits<integer>::max(), high = 0;
+    for (size_t i = lo; i < hi; ++i) {
+      low = min(low, mtx[perm[i]][col]);
+      high = max(high, mtx[perm[i]][col]);
+    }
+    const size_t range = size_t(high) - low + 1;
+    if (range == 1)
+      continue; // one bucket, go to the next column
+    if (range > max<size_t>(256, hi - lo)) {
+      std::sort(perm.begin() + lo, perm.begin() + hi, less);
+      return;
     }
-  }
-  std::swap(mtx[high], mtx[p_index]);
-
-  return p_index;
-}
 
-void sort_matrix(Matrix &mtx, size_t low, size_t high) {
-  if (low < high) {
-    size_t p_index = partition_matrix(mtx, low, high);
-    sort_matrix(mtx, low, p_index - 1);
-    sort_matrix(mtx, p_index + 1, high);
+    vector<size_t> start(range + 1, 0);
+    for (size_t i = lo; i < hi; ++i)
+      ++start[mtx[perm[i]][col] - low + 1];
+    start[0] = lo;
+    for (size_t v = 0; v < range; ++v)
+      start[v + 1] += start[v];
+    vector<size_t> next(start.cbegin(), start.cend() - 1);
+    for (size_t i = lo; i < hi; ++i)
+      temp[next[mtx[perm[i]][col] - low]++] = perm[i];
+    copy(temp.cbegin() + lo, temp.cbegin() + hi, perm.begin() + lo);
+    for (size_t v = 0; v < range; ++v)
+      if (start[v + 1] - start[v] > 1)
+        radix_sort(mtx, perm, temp, start[v], start[v + 1], col + 1);
+    return;
+  }
+}
+
+void Matrix::sort() {
+  vector<size_t> perm(num_rows()), temp(num_rows());
+  iota(perm.begin(), perm.end(), 0);
+  radix_sort(*this, perm, temp, 0, num_rows(), 0);
+  // row perm[i] goes to place i: follow the cycles of the permutation,
+  // holding one row aside
+  vector<integer> aside(ncols);
+  for (size_t start = 0; start < nrows; ++start) {
+    if (perm[start] == start)
+      continue;
+    std::copy_n(row_values(start), ncols, aside.begin());
+    size_t i = start;
+    while (perm[i] != start) {
+      std::copy_n(row_values(perm[i]), ncols, row_values(i));
+      const size_t next = perm[i];
+      perm[i] = i;
+      i = next;
+    }
+    std::copy(aside.cbegin(), aside.cend(), row_values(i));
+    perm[i] = i;
   }
 }
 
-void Matrix::sort() { sort_matrix((Matrix &)(*this), 0, num_rows() - 1); }
-
 void Matrix::remove_duplicates() {
-  auto ip = unique(data.begin(), data.end());
-  data.resize(size_t(distance(data.begin(), ip)));
+  if (nrows == 0)
+    return;
+  size_t last = 0;
+  for (size_t i = 1; i < nrows; ++i)
+    if (!((*this)[last] == (*this)[i])) {
+      ++last;
+      if (last != i)
+        std::copy_n(row_values(i), ncols, row_values(last));
+    }
+  nrows = last + 1;
+  values.resize(nrows * ncols);
 }
 
 //------------------------------------------------------------------------------
@@ -342,7 +422,7 @@ bool sat_formula(const RowView &tuple, const Formula &formula) {
 }
 
 // does the tuple satisfy the clause?
-bool sat_clause(const Row &tuple, const Clause &clause) {
+bool sat_clause(RowSpan tuple, const Clause &clause) {
   for (size_t i = 0; i < tuple.size(); ++i) {
     if (clause[i].sat(tuple[i])) {
       return true;
@@ -352,7 +432,7 @@ bool sat_clause(const Row &tuple, const Clause &clause) {
 }
 
 // does the tuple satisfy the formula?
-bool sat_formula(const Row &tuple, const Formula &formula) {
+bool sat_formula(RowSpan tuple, const Formula &formula) {
   for (const Clause &cl : formula) {
     if (!sat_clause(tuple, cl)) {
       return false;
@@ -469,6 +549,72 @@ vector<string> split(string strg, const string &delimiters) {
   return chunks;
 }
 
+unsigned domain_bits(const string &header) {
+  ifstream hdr(header);
+  if (!hdr.is_open())
+    return 0;
+  size_t dmax = 0;
+  string line;
+  while (getline(hdr, line)) {
+    const vector<string> hds = split(line, ":");
+    if (hds.size() > 2)
+      dmax = max<size_t>(dmax, stoull(hds[2]));
+  }
+  // DMAX + 2 must fit: mcp-trans numbers intervals from 1, so a column
+  // may hold DMAX + 1, and the learners step one past a value
+  return dmax < 0xfe ? 8 : dmax < 0xfffe ? 16 : 32;
+}
+
+void dispatch_width(const string &header, char **argv) {
+  if (header.empty())
+    return;
+  const unsigned bits = domain_bits(header);
+  if (bits == 0 || bits == INTEGER_BITS)
+    return;
+
+  // mcp-seq-mekong is 16 bits wide, mcp-seq-mekong8 8 bits, ...;
+  // mcp-module verified the SHA3 of every sibling before starting us
+  string name = argv[0];
+  const string own = INTEGER_BITS == 16 ? "" : to_string(INTEGER_BITS);
+  if (name.size() >= own.size() &&
+      name.compare(name.size() - own.size(), own.size(), own) == 0)
+    name.resize(name.size() - own.size());
+  if (bits != 16)
+    name += to_string(bits);
+  cout.flush();
+  char *self = argv[0];
+  argv[0] = name.data();
+  execvp(argv[0], argv);
+  argv[0] = self;
+
+  // a wider build is still correct, only slower
+  if (bits > INTEGER_BITS) {
+    cerr << "+++ the header " << header << " needs " << bits
+         << "-bit values, but " << name << " cannot be run" << endl;
+    exit(2);
+  }
+}
+
+integer read_dmax(const string &field, const string &name) {
+  const unsigned long long dmax = stoull(field);
+  if (dmax > numeric_limits<integer>::max()) {
+    cerr << "+++ DMAX " << dmax << " of " << name << " exceeds the "
+         << INTEGER_BITS << "-bit values of this build" << endl;
+    exit(2);
+  }
+  return integer(dmax);
+}
+
+integer read_value(const string &field, size_t numline) {
+  const unsigned long long x = stoull(field);
+  if (x > numeric_limits<integer>::max()) {
+    cerr << "+++ value " << x << " on line " << numline << " exceeds the "
+         << INTEGER_BITS << "-bit values of this build" << endl;
+    exit(2);
+  }
+  return integer(x);
+}
+
 // transforms clause into readable clausal form in (extended) DIMACS
 // format to print
 string clause2dimacs(const vector<size_t> &names, const Clause &clause) {
@@ -810,14 +956,14 @@ void read_formula(vector<size_t> &names, Formula &formula) {
   }
 }
 
-ostream &operator<<(ostream &output, const Row &row) {
+ostream &operator<<(ostream &output, RowSpan row) {
   // overloading ostream to print a row
   // transforms a tuple (row) to a printable form
   // for (bool bit : row)
   for (size_t i = 0; i < row.size(); ++i)
     // output << to_string(bit); // bit == true ? 1 : 0;
     // output << to_string(row[i]);
-    output << row[i] << " ";
+    output << size_t(row[i]) << " ";
   return output;
 }
 
@@ -828,7 +974,7 @@ ostream &operator<<(ostream &output, const RowView &row) {
   for (size_t i = 0; i < row.size(); ++i)
     // output << to_string(bit); // bit == true ? 1 : 0;
     // output << to_string(row[i]);
-    output << row[i] << " ";
+    output << size_t(row[i]) << " ";
   return output;
 }
 
@@ -841,7 +987,7 @@ ostream &internal_matrix_display(ostream &output, const M &m) {
   for (size_t i = 0; i < max_to_show; ++i) {
     output << "\t";
     for (size_t j = 0; j < m.num_cols(); ++j) {
-      output << m[i][j] << " ";
+      output << size_t(m[i][j]) << " ";
     }
     output << "\n";
   }
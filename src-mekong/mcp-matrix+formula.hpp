@@ -25,6 +25,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <functional>
@@ -40,7 +41,7 @@
 
 #include "mcp-trans.hpp"
 
-#define GLOBAL_VERSION "1.05d-mekong-"
+#define GLOBAL_VERSION "1.05e-mekong-"
 
 //------------------------------------------------------------------------------
 
@@ -48,8 +49,21 @@ extern std::string version;
 extern const std::string print_strg[];
 extern const std::string display_strg[];
 
-// domain value type
+// domain value type, 8, 16 or 32 bits wide (WIDTH in the Makefile); the
+// plain binaries are 16 bits wide, the others carry the width in their
+// name and are run by dispatch_width
+#ifndef INTEGER_BITS
+#define INTEGER_BITS 16
+#endif
+#if INTEGER_BITS == 8
+using integer = uint8_t;
+#elif INTEGER_BITS == 16
 using integer = uint16_t;
+#elif INTEGER_BITS == 32
+using integer = uint32_t;
+#else
+#error "INTEGER_BITS must be 8, 16 or 32"
+#endif
 // maximum value of the domain for each coordinate (cardinality - 1)
 
 // one line in header
@@ -72,137 +86,253 @@ extern vector<Headline> headlines;
 
 class RowView;
 
+// hash of a sequence of domain values, shared by Row and RowView so that
+// a row and a view with the same values hash alike: the values are packed
+// into 64-bit words, each word is mixed in with a multiply and an
+// xor-shift, and the result is never 0 (0 marks "not cached")
+template <typename R> inline size_t hash_values(const R &r) noexcept {
+  constexpr uint64_t K1 = 0x9e3779b97f4a7c15, K2 = 0xbf58476d1ce4e5b9;
+  constexpr size_t PER = 8 / sizeof(integer); // values per word
+  const size_t n = r.size();
+  uint64_t h = K1 ^ n;
+  for (size_t i = 0; i < n; i += PER) {
+    uint64_t w = 0;
+    for (size_t k = 0; k < PER && i + k < n; ++k)
+      w |= uint64_t(r[i + k]) << (k * INTEGER_BITS);
+    h = (h ^ w) * K2;
+    h ^= h >> 29;
+  }
+  h = (h ^ (h >> 32)) * K1;
+  h ^= h >> 29;
+  return h == 0 ? 1 : size_t(h);
+}
+
 // mask into a row
 using Mask = std::vector<bool>;
 
-// data structure representing a matrix row
+class Row;
+
+// read-only view of the values of one row, owned by a Row or a Matrix;
+// valid until its owner is modified or destroyed
+class RowSpan {
+private:
+  const integer *values;
+  size_t count;
+
+public:
+  inline RowSpan(const integer *values, size_t count) noexcept
+    : values(values), count(count) {}
+
+  // get the size of the row
+  inline size_t size() const noexcept { return count; }
+  // constant index operation
+  inline const integer &operator[](size_t index) const noexcept {
+    return values[index];
+  }
+  inline const integer *data() const noexcept { return values; }
+  inline const integer *begin() const noexcept { return values; }
+  inline const integer *end() const noexcept { return values + count; }
+
+  // copies the values to a new row
+  Row to_row() const;
+  inline Row clone() const;
+
+  // total alphabetical order on rows.
+  // - if self < other, return -1
+  // - if self == other, return 0
+  // - if self > other, return 1
+  inline int total_order(RowSpan other) const noexcept {
+    size_t i = 0;
+    for (; i < size() && i < other.size(); ++i) {
+      if (values[i] < other[i])
+        return -1;
+      if (values[i] > other[i])
+        return 1;
+    }
+    if (i < size())
+      return 1;
+    if (i < other.size())
+      return -1;
+    return 0;
+  }
+
+  // compute the z-score (standard score) of a row
+  double zscore() const;
+};
+
+bool operator>=(RowSpan, RowSpan);
+bool operator>(RowSpan, RowSpan);
+bool operator==(RowSpan, RowSpan);
+
+// a row owning its values, for rows living outside of a matrix
 class Row {
 public:
   using container = std::vector<integer>;
 
 private:
   container data;
+  // hash of data, 0 until computed; every non-const member resets it.
+  // relaxed atomic, since threads may hash the same const row at once
+  mutable std::atomic<size_t> hashed{0};
+
+  inline void invalidate() & noexcept {
+    hashed.store(0, std::memory_order_relaxed);
+  }
 
 public:
   inline explicit Row() = default;
   inline explicit Row(size_t size) : data(container(size)) {}
 
   // constructs a row from rvalue data
-  inline explicit Row(container &&data) : data(data) {}
+  inline explicit Row(container &&data) : data(std::move(data)) {}
 
   Row(const Row &) = delete;
-  Row(Row &&) = default;
-  Row &operator=(Row &&) = default;
+  inline Row(Row &&other) noexcept
+    : data(std::move(other.data)),
+      hashed(other.hashed.load(std::memory_order_relaxed)) {
+    other.invalidate();
+  }
+  inline Row &operator=(Row &&other) & noexcept {
+    data = std::move(other.data);
+    hashed.store(other.hashed.load(std::memory_order_relaxed),
+		 std::memory_order_relaxed);
+    other.invalidate();
+    return *this;
+  }
   // explicitely clone the row
   inline Row clone() const & { return Row(container(data)); }
   inline Row to_row() const & { return clone(); }
 
+  // read-only view of the values
+  inline operator RowSpan() const noexcept {
+    return RowSpan(data.data(), data.size());
+  }
+
   // get the size of the row
   inline size_t size() const & noexcept { return data.size(); }
   // constant index operation
   inline const integer &operator[](size_t index) const & noexcept {
     return data[index];
   }
-  // mutable index operation
-  inline integer &operator[](size_t index) & noexcept { return data[index]; }
+  // set the value at index; the only way to write a single value, so
+  // that the cached hash cannot outlive it
+  inline void set(size_t index, integer value) & noexcept {
+    invalidate();
+    data[index] = value;
+  }
   // add a value to the end of the row
-  inline void push_back(integer value) & { data.push_back(value); }
+  inline void push_back(integer value) & {
+    invalidate();
+    data.push_back(value);
+  }
   // preallocate enough memory for the specified number of values
   inline void reserve(size_t size) & { data.reserve(size); }
   // resize the row to the given size
-  inline void resize(size_t size) & { data.resize(size); }
-
-  // set the row to the (element-wise) minimum between itself and other
-  void inplace_minimum(const Row &other) &;
-  // set the row to the (element-wise) minimum between itself and other
-  void inplace_minimum(const RowView &other) &;
+  inline void resize(size_t size) & {
+    invalidate();
+    data.resize(size);
+  }
 
-  // total alphabetical order on rows.
-  // - if self < other, return -1
-  // - if self == other, return 0
-  // - if self > other, return 1
-  inline int total_order(const Row &other) const & {
-    size_t i = 0;
-    for (; i < size() && i < other.size(); ++i) {
-      if (data[i] < other[i])
-        return -1;
-      if (data[i] > other[i])
-        return 1;
+  // hash of the values, computed once and cached until the next mutation
+  inline size_t hash() const & noexcept {
+    size_t h = hashed.load(std::memory_order_relaxed);
+    if (h == 0) {
+      h = hash_values(*this);
+      hashed.store(h, std::memory_order_relaxed);
     }
-    if (i < size())
-      return 1;
-    if (i < other.size())
-      return -1;
-    return 0;
+    return h;
   }
 
-  // restricts the row to the given set of columns
-  void restrict(const Mask &m);
-  // compute the z-score (standard score) of a row
-  double zscore() const;
-
-  bool operator>=(const Row &) const;
-  bool operator>(const Row &) const;
-  bool operator==(const Row &) const;
+  // set the row to the (element-wise) minimum between itself and other
+  void inplace_minimum(RowSpan other) &;
+  // set the row to the (element-wise) minimum between itself and other
+  void inplace_minimum(const RowView &other) &;
 };
 
-// basic matrix class
+inline Row RowSpan::to_row() const {
+  return Row(Row::container(values, values + count));
+}
+inline Row RowSpan::clone() const { return to_row(); }
+
+// basic matrix class: the rows are kept one after the other in a single
+// buffer, row i starting at value i * num_cols()
 class Matrix {
 public:
-  using container = std::vector<Row>;
+  using container = std::vector<integer>;
 
 private:
+  size_t ncols = 0;    // values per row
+  size_t nrows = 0;
+  size_t reserved = 0; // rows to reserve once ncols is known
   // the actual data contained in the matrix
-  container data;
+  container values;
 
 public:
   // empty matrix
   Matrix() = default;
-  // constructs a matrix from rvalue data
-  inline Matrix(container &&data) : data(std::move(data)) {}
 
   Matrix(const Matrix &) = delete;
-  Matrix(Matrix &&) = default;
-  Matrix &operator=(Matrix &&) = default;
+  inline Matrix(Matrix &&other) noexcept
+    : ncols(std::exchange(other.ncols, 0)),
+      nrows(std::exchange(other.nrows, 0)),
+      reserved(std::exchange(other.reserved, 0)),
+      values(std::move(other.values)) {
+    other.values.clear();
+  }
+  inline Matrix &operator=(Matrix &&other) noexcept {
+    ncols = std::exchange(other.ncols, 0);
+    nrows = std::exchange(other.nrows, 0);
+    reserved = std::exchange(other.reserved, 0);
+    values = std::move(other.values);
+    other.values.clear();
+    return *this;
+  }
   // explicitely clone the matrix
   inline Matrix clone() const & {
     Matrix res;
-    res.reserve(num_rows());
-    for (size_t i = 0; i < num_rows(); ++i)
-      res.add_row(operator[](i).clone());
+    res.ncols = ncols;
+    res.nrows = nrows;
+    res.values = values;
     return res;
   }
 
   // checks wether the matrix is empty
-  inline bool empty() const noexcept { return data.empty(); }
+  inline bool empty() const noexcept { return nrows == 0; }
   // reserves space for the rows
-  inline void reserve(size_t size) { data.reserve(size); }
+  inline void reserve(size_t size) {
+    if (ncols > 0)
+      values.reserve(size * ncols);
+    else
+      reserved = size;
+  }
   // returns the number of rows
-  inline size_t num_rows() const noexcept { return data.size(); }
+  inline size_t num_rows() const noexcept { return nrows; }
   // returns the number of columns
-  inline size_t num_cols() const noexcept {
-    return data.size() > 0 ? data[0].size() : 0;
-  }
+  inline size_t num_cols() const noexcept { return nrows > 0 ? ncols : 0; }
 
   // equivalent to M[row][col]
   inline integer get(size_t row, size_t col) const noexcept {
-    return data[row][col];
+    return values[row * ncols + col];
   }
   // returns a const view into a row
-  inline const Row &operator[](size_t index) const { return data[index]; }
-
-  // returns a mutable view into a row
-  inline Row &operator[](size_t index) { return data[index]; }
+  inline RowSpan operator[](size_t index) const noexcept {
+    return RowSpan(values.data() + index * ncols, ncols);
+  }
+  // the values of a row, for writing
+  inline integer *row_values(size_t index) noexcept {
+    return values.data() + index * ncols;
+  }
 
-  // add a new row to the matrix
-  inline void add_row(Row &&new_row) & { data.push_back(std::move(new_row)); }
+  // add a copy of a row to the matrix; the first row fixes the number of
+  // columns
+  void add_row(RowSpan new_row) &;
 
   // deletes a row without preserving row order
   void delete_row(size_t index);
 
-  // restricts the matrix to the given set of columns
+  // restricts the matrix to the given set of columns, in place
   void restrict(const Mask &m);
-  // sort the matrix according to the total order on rows
+  // sort the matrix according to the total order on rows, in place
   void sort();
   // remove duplicate rows in a sorted matrix. useful after a restriction.
   void remove_duplicates();
@@ -219,12 +349,12 @@ public:
   using permutation = std::vector<size_t>;
 
 private:
-  const Row &data;
+  RowSpan data;
   const permutation &cols;
 
 public:
   // construct a new masked row from the original data and the column mask
-  inline explicit RowView(const Row &data, const permutation &cols)
+  inline explicit RowView(RowSpan data, const permutation &cols)
     : data(data), cols(cols) {}
 
   // get the size of the masked row
@@ -234,11 +364,11 @@ public:
   inline integer operator[](size_t index) const { return data[cols[index]]; }
 
   bool operator>=(const RowView &) const;
-  bool operator>=(const Row &) const;
+  bool operator>=(RowSpan) const;
   bool operator>(const RowView &) const;
-  bool operator>(const Row &) const;
+  bool operator>(RowSpan) const;
   bool operator==(const RowView &) const;
-  bool operator==(const Row &) const;
+  bool operator==(RowSpan) const;
 
   // copies the masked row to a new one.
   Row to_row() const;
@@ -295,6 +425,8 @@ public:
   inline size_t num_rows() const { return matrix.get().num_rows(); }
   // returns the number of columns
   inline size_t num_cols() const { return cols.size(); }
+  // the visible columns of the underlying matrix, in order
+  inline const permutation &columns() const { return cols; }
 
   // equivalent to M[row][col], with the mask applied
   inline integer get(size_t row, size_t col) const {
@@ -445,6 +577,16 @@ bool clear_line (const size_t lineno, std::string &line);
 void uncomma_line (std::string &line);
 // split a string along the specified delimiters
 std::vector<std::string> split(std::string, const std::string &);
+// the narrowest width, 8, 16 or 32 bits, holding DMAX + 2 of every column
+// described in the header file; 0 if it cannot be read
+unsigned domain_bits(const std::string &header);
+// runs, with the same arguments, the build of the program whose width is
+// domain_bits(header) if it is not this one; returns if this one fits
+void dispatch_width(const std::string &header, char **argv);
+// the DMAX field of a header line; stops if this build cannot hold it
+integer read_dmax(const std::string &field, const std::string &name);
+// a value of input line numline; stops if this build cannot hold it
+integer read_value(const std::string &field, size_t numline);
 // get the Extended DIMACS representation of a formula
 std::string formula2dimacs(const std::vector<size_t> &names,
                            const Formula &formula);
@@ -463,9 +605,9 @@ bool sat_clause(const RowView &tuple, const Clause &clause);
 bool sat_formula(const RowView &tuple, const Formula &formula);
 
 // checks that a row satisfies a clause
-bool sat_clause(const Row &tuple, const Clause &clause);
+bool sat_clause(RowSpan tuple, const Clause &clause);
 // checks that a row satisfies a formula
-bool sat_formula(const Row &tuple, const Formula &formula);
+bool sat_formula(RowSpan tuple, const Formula &formula);
 
 // checks that all rows in a matrix satisfy a clause
 bool sat_clause(const Matrix &matrix, const Clause &clause);
@@ -473,7 +615,7 @@ bool sat_clause(const Matrix &matrix, const Clause &clause);
 bool sat_formula(const Matrix &matrix, const Formula &formula);
 
 // display a row
-std::ostream &operator<<(std::ostream &output, const Row &row);
+std::ostream &operator<<(std::ostream &output, RowSpan row);
 // display a row view
 std::ostream &operator<<(std::ostream &output, const RowView &row);
 // display a matrix
@@ -490,52 +632,50 @@ constexpr size_t hash_combine(size_t a, size_t b) {
   return a;
 }
 
-// specialization of hash for Row
+// specialization of hash for Row, cached in the row
 template <> class std::hash<Row> {
 public:
-  size_t operator()(const Row &r) const noexcept {
-    size_t res = 0;
-    for (size_t i = 0; i < r.size(); ++i) {
-      hash_combine(res, std::hash<integer>{}(r[i]));
-    }
-    return res;
-  }
+  size_t operator()(const Row &r) const noexcept { return r.hash(); }
 };
 
-// specialization of hash for RowView
+// specialization of hash for RowSpan, equal to the hash of to_row()
+template <> class std::hash<RowSpan> {
+public:
+  size_t operator()(RowSpan r) const noexcept { return hash_values(r); }
+};
+
+// specialization of hash for RowView, equal to the hash of to_row()
+// but read through the column permutation without building the row
 template <> class std::hash<RowView> {
 public:
-  size_t operator()(const RowView &r) const noexcept {
-    size_t res = 0;
-    for (size_t i = 0; i < r.size(); ++i) {
-      hash_combine(res, std::hash<integer>{}(r[i]));
-    }
-    return res;
-  }
+  size_t operator()(const RowView &r) const noexcept { return hash_values(r); }
 };
 
+// a literal packed into one word: pval, nval and the sign on top
+constexpr uint64_t literal_word(const Literal &l) {
+  return (uint64_t(l.pval) | uint64_t(l.nval) << 32) ^ uint64_t(l.sign) << 62;
+}
+
 template <> class std::hash<Literal> {
 public:
   size_t operator()(const Literal &l) const noexcept {
-    size_t res = std::hash<Sign>{}(l.sign);
-    if (l.sign & lneg) {
-      res = hash_combine(res, std::hash<size_t>{}(l.nval));
-    }
-    if (l.sign & lpos) {
-      res = hash_combine(res, std::hash<size_t>{}(l.pval));
-    }
-    return res;
+    const uint64_t h = literal_word(l) * 0xbf58476d1ce4e5b9;
+    return size_t(h ^ (h >> 29));
   }
 };
 
+// the packed literals mixed in one after the other, as in hash_values
 template <> class std::hash<Clause> {
 public:
   size_t operator()(const Clause &c) const noexcept {
-    size_t res = 0;
-    for (auto l : c) {
-      res = hash_combine(res, std::hash<Literal>{}(l));
+    constexpr uint64_t K1 = 0x9e3779b97f4a7c15, K2 = 0xbf58476d1ce4e5b9;
+    uint64_t h = K1 ^ c.size();
+    for (const Literal &l : c) {
+      h = (h ^ literal_word(l)) * K2;
+      h ^= h >> 29;
     }
-    return res;
+    h = (h ^ (h >> 32)) * K1;
+    return size_t(h ^ (h >> 29));
   }
 };
 
@@ -249,7 +249,7 @@ namespace mesh {
   void populate(const Matrix &positiveT,
 		Strip &strip, Mesh &mesh, size_t arity) {
     for (size_t k = 0; k < positiveT.num_rows(); ++k) {
-      const Row &m = positiveT[k];
+      const RowSpan m = positiveT[k];
       for (size_t i = 0; i < arity; ++i) {
 	strip[i].insert(m[i]);
 	for (size_t j = i+1; j < arity; ++j)
@@ -262,14 +262,14 @@ namespace mesh {
 
 ostream &operator<<(ostream &output, const Point &p) {
   // overloading ostream to print a point
-  output << "[" << p[bucket::X] << "," << p[bucket::Y] << "]";
+  output << "[" << size_t(p[bucket::X]) << "," << size_t(p[bucket::Y]) << "]";
   return output;
 }
 
 ostream &operator<<(ostream &output, const mesh::ColNode &cn) {
   if (cn.south != nullptr)
     output << *(cn.south);
-  output << " " << cn.value_j;
+  output << " " << size_t(cn.value_j);
   if (cn.north != nullptr)
     output << *(cn.north);
   return output;
@@ -284,7 +284,7 @@ ostream &operator<<(ostream &output, const mesh::ColTree &ct) {
 ostream &operator<<(ostream &output, const mesh::RowNode &rn) {
   if (rn.west != nullptr)
     output << *(rn.west);
-  output << "... row " << rn.value_i << ": " << *(rn.column) << "." << endl;
+  output << "... row " << size_t(rn.value_i) << ": " << *(rn.column) << "." << endl;
   if (rn.east != nullptr)
     output << *(rn.east);
   return output;
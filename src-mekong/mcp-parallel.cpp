@@ -37,6 +37,8 @@
 #include "mcp-common.hpp"
 #include "mcp-matrix+formula.hpp"
 #include "mcp-parallel.hpp"
+#include "mcp-pool.hpp"
+#include "mcp-posix.hpp"
 #include "mcp-mesh.hpp"
 
 using namespace std;
@@ -121,6 +123,10 @@ void print_arg () {
   outfile << "@@@ var. offset   = " << offset << endl;
   if (arch != archMPI)
     outfile << "@@@ chunk limit   = " << chunkLIMIT << endl;
+  if (arch == archPTHREAD) {
+    outfile << "@@@ threads       = " << thread_pool().size() << endl;
+    outfile << "@@@ buffer limit  = " << bufferLIMIT << " MB" << endl;
+  }
   if (arch != archPTHREAD)
     outfile << "@@@ proc.num. fit = " << (np_fit ? "yes" : "no") << endl;
   outfile << "@@@ print matrix  = " << display_strg[display]
@@ -152,7 +158,7 @@ void read_header () {
       vector<string> hds = split(line, ":");
       string name = hds[nOWN];
       Token tk = reverse_string.at(hds[1]);
-      integer dmax = integer(stoull(hds[2]));
+      integer dmax = read_dmax(hds[2], name);
       vector<string> elems;
       move(hds.begin()+3, hds.end(), back_inserter(elems));
       Headline hdl(name, tk, dmax, elems);
@@ -180,7 +186,7 @@ void read_matrix (Group_of_Matrix &matrix) {
       outfile << "*** arity discrepancy on line " << numline << endl;
     Row temp;
     for (size_t i = 1; i < nums.size(); ++i) {
-      integer x = integer(stoull(nums.at(i)));
+      integer x = read_value(nums.at(i), numline);
       temp.push_back(x);
     }
     if (matrix.find(group) == matrix.end())
@@ -224,83 +230,59 @@ void print_matrix (const Group_of_Matrix &matrix) {
   outfile << endl;
 }
 
-// selects rows of matrix above the input row, computes their minimum
-// then checks wether the row is equal to the minimum
-template <typename R, typename M>
-bool InHornClosure(const R &row, const M &matrix) {
-  if (matrix.empty())
-    return false;
-  Row MIN;
-  bool any_above = false;
-  for (size_t i = 0; i < matrix.num_rows(); ++i) {
-    const R &r = matrix[i];
-    if (r >= row) {
-      if (any_above)
-        MIN.inplace_minimum(r);
-      else {
-        MIN = r.to_row();
-        any_above = true;
-      }
-    }
-  }
-  return any_above && row == MIN;
-}
-
+// the tuple is in the Horn closure of the matrix iff it is the meet of
+// the rows above it, see ObsGeq
 bool InHornClosure(const RowView &r, const MatrixMask &m) {
-  return InHornClosure<RowView, MatrixMask>(r, m);
+  Row meet;
+  return ObsGeq(r, m, meet) && r == meet;
 }
-bool InHornClosure(const Row &r, const Matrix &m) {
-  return InHornClosure<Row, Matrix>(r, m);
+bool InHornClosure(RowSpan r, const Matrix &m) {
+  Row meet;
+  return ObsGeq(r, m, meet) && r == meet;
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
 // learn a Horn clause from positive samples T and negative samples F
 // with the large strategy
-Formula learnHornLarge (ofstream &p_outfile,
+Formula learnHornLarge (ostream &p_outfile,
 			const Matrix &positiveT, const Matrix &negativeF,
 			const vector<size_t> &A) {
   Formula varphi;
-  size_t arity = positiveT.num_cols();
-
-  vector<size_t> names(arity);
-  for (size_t i = 0; i < arity; ++i)
-    names[i] = i;
-
-  for (size_t i = 0; i < negativeF.num_rows(); ++i) {
-    const Row &f = negativeF[i];
-    if (!sat_formula(f, varphi)) {
-      continue;
-    }
-
-    Clause clause;
-    clause.reserve(arity);
-    for (size_t i = 0; i < arity; ++i) {
-      Sign sign = f[i] > 0 ? lneg : lnone;
-      integer val = f[i] > 0 ? f[i] - 1 : 0;
-      Literal lit(sign, 0, val);
-      clause.push_back(lit);
-    }
-    bool found = sat_clause(positiveT, clause);
-    size_t j = 0;
-    Literal old;
-    while (!found && j < arity) {
-      if (f[j] < headlines[A[j]].DMAX) {
-	old = clause[j];
-	clause[j].sign = (Sign)(clause[j].sign | lpos);
-	clause[j].pval = f[j] + 1;
-	found = sat_clause(positiveT, clause);
-	if (!found)
-	  clause[j] = old;
+  const Matrix T = meet_irreducible(positiveT);
+  const ThresholdIndex index(T);
+
+  // the samples not yet falsified by varphi are eliminated in rounds of a
+  // few samples per thread; a sample falsified by a clause learnt earlier
+  // in the same round is skipped, exactly as in sequential order
+  const size_t round = 4 * thread_pool().size();
+  size_t next = 0;
+  while (next < negativeF.num_rows()) {
+    vector<size_t> batch;
+    for (; next < negativeF.num_rows() && batch.size() < round; ++next)
+      if (sat_formula(negativeF[next], varphi))
+	batch.push_back(next);
+
+    vector<Clause> clauses(batch.size());
+    vector<char> found(batch.size());
+    thread_pool().parallel_for(0, batch.size(),
+			       [&] (const size_t k) {
+				 found[k] = HornClause(negativeF[batch[k]], T,
+						       index, A, clauses[k]);
+			       });
+
+    const size_t before = varphi.size();
+    for (size_t k = 0; k < batch.size(); ++k) {
+      const RowSpan f = negativeF[batch[k]];
+      if (varphi.size() > before && !sat_formula(f, varphi))
+	continue;
+      if (!found[k]) {
+	p_outfile << "+++ negative example present in Horn closure of T" << endl;
+	p_outfile << "+++ the negative culprit is '" << f << "'" << endl;
+	exit(2);
       }
-      j++;
-    }
-    if (!found) {
-      p_outfile << "+++ negative example present in Horn closure of T" << endl;
-      p_outfile << "+++ the negative culprit is '" << f << "'" << endl;
-      exit(2);
+      varphi.push_back(std::move(clauses[k]));
     }
-    varphi.push_back(std::move(clause));
   }
 
   cook(varphi);
@@ -308,7 +290,7 @@ Formula learnHornLarge (ofstream &p_outfile,
 }
 
 // learn a bijunctive clause from positive samples T and negative samples F
-Formula learn2sat (ofstream &p_outfile, const Matrix &positiveT, const Matrix &negativeF) {
+Formula learn2sat (ostream &p_outfile, const Matrix &positiveT, const Matrix &negativeF) {
   bucket::Bucket bucket;
   mesh::Strip strip;
   mesh::Mesh mesh;
@@ -319,7 +301,7 @@ Formula learn2sat (ofstream &p_outfile, const Matrix &positiveT, const Matrix &n
   mesh::populate(positiveT, strip, mesh, arity);
 
   for (size_t k = 0; k < negativeF.num_rows(); ++k) {
-    const Row &f = negativeF[k];
+    const RowSpan f = negativeF[k];
 
     if (!(bucket::sat_bucket(f, bucket)))
       continue;
@@ -370,7 +352,7 @@ Formula learn2sat (ofstream &p_outfile, const Matrix &positiveT, const Matrix &n
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-Formula post_prod(ofstream &process_outfile, ofstream &latex_outfile,
+Formula post_prod(ostream &process_outfile, ostream &latex_outfile,
 	       const vector<size_t> &A, const Matrix &F, const Formula &formula) {
   Formula schf;
   if (setcover) {
@@ -417,7 +399,7 @@ Formula post_prod(ofstream &process_outfile, ofstream &latex_outfile,
   return schf;
 }
 
-Formula post_prod(ofstream &process_outfile, ofstream &latex_outfile,
+Formula post_prod(ostream &process_outfile, ostream &latex_outfile,
 		  const Matrix &F, const Formula &formula) {
   vector<size_t> names(formula[0].size());
   for (size_t i = 0; i < formula[0].size(); ++i)
@@ -429,100 +411,97 @@ Formula post_prod(ofstream &process_outfile, ofstream &latex_outfile,
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-// one group as positive agains one group of negative samples
-void one2one (ofstream &process_outfile, ofstream &latex_outfile, const int &i) {
+// group i of positive samples against group j of negative samples
+void one2one (ostream &process_outfile, ostream &latex_outfile,
+	      const size_t i, const size_t j) {
   Matrix T = group_of_matrix.at(grps[i]).clone();
-  for (size_t j = 0; j < grps.size(); ++j) {
-    if (j == i)
-      continue;
-    Matrix F = group_of_matrix.at(grps[j]).clone();
+  Matrix F = group_of_matrix.at(grps[j]).clone();
 
-    if (closure == clDHORN) {
-      process_outfile << "+++ swapping polarity of vectors and treating swapped vectors as Horn"
-		      << endl;
-      polswap_matrix(T);
-      polswap_matrix(F);
-    }
+  if (closure == clDHORN) {
+    process_outfile << "+++ swapping polarity of vectors and treating swapped vectors as Horn"
+		    << endl;
+    polswap_matrix(T);
+    polswap_matrix(F);
+  }
 
-    Mask sect = minsect(T, F);
-    if (nosection)
-      process_outfile << "+++ Groups ";
-    else
-      process_outfile << "+++ Section of groups ";
-    process_outfile << "T=" << grps[i] << " and F=" << grps[j] << ":" << endl;
-    
-    if (!disjoint) {
-      process_outfile << "+++ Matrices <T> and F are not disjoint, therefore I cannot infer a formula"
-		      << endl << endl;
-    } else {
-      vector<size_t> A;
-      if (!nosection) {
-	// int hw = hamming_weight(sect);
-	int hw = std::accumulate(sect.cbegin(), sect.cend(), 0);
-	process_outfile << "+++ Relevant variables [" << hw << "]: ";
-	for (size_t k = 0; k < sect.size(); ++k)
-	  if (sect[k]) {
-	    A.push_back(k);
-	    if (varswitch) {
-	      process_outfile << headlines[k].name;
-	    } else
-	      process_outfile << varid << to_string(offset+k);
-	    process_outfile << " ";
-	  }
-	process_outfile << endl;
-	process_outfile << "+++ A [" << hw << "] = {";
-	for (const size_t &coord : A)
-	  process_outfile << offset + coord << " ";
-	process_outfile << "}" << endl;
-	T.restrict(sect);
-	F.restrict(sect);
-
-	process_outfile << "+++ T|_A [" << T.num_rows() << "]";
-	if (display >= ySECTION) {
-	  process_outfile << " = { " << endl;
-	  process_outfile << T;
-	  process_outfile << "+++ }";
+  Mask sect = minsect(T, F);
+  if (nosection)
+    process_outfile << "+++ Groups ";
+  else
+    process_outfile << "+++ Section of groups ";
+  process_outfile << "T=" << grps[i] << " and F=" << grps[j] << ":" << endl;
+  
+  if (!disjoint) {
+    process_outfile << "+++ Matrices <T> and F are not disjoint, therefore I cannot infer a formula"
+		    << endl << endl;
+  } else {
+    vector<size_t> A;
+    if (!nosection) {
+      // int hw = hamming_weight(sect);
+      int hw = std::accumulate(sect.cbegin(), sect.cend(), 0);
+      process_outfile << "+++ Relevant variables [" << hw << "]: ";
+      for (size_t k = 0; k < sect.size(); ++k)
+	if (sect[k]) {
+	  A.push_back(k);
+	  if (varswitch) {
+	    process_outfile << headlines[k].name;
+	  } else
+	    process_outfile << varid << to_string(offset+k);
+	  process_outfile << " ";
 	}
-	process_outfile << endl;
+      process_outfile << endl;
+      process_outfile << "+++ A [" << hw << "] = {";
+      for (const size_t &coord : A)
+	process_outfile << offset + coord << " ";
+      process_outfile << "}" << endl;
+      T.restrict(sect);
+      F.restrict(sect);
 
-	process_outfile << "+++ F|_A [" << F.num_rows() << "]";
-	if (display >= ySECTION) {
-	  process_outfile << " = { " << endl;
-	  process_outfile << F;
-	  process_outfile << "+++ }";
-	}
-	process_outfile << endl;
+      process_outfile << "+++ T|_A [" << T.num_rows() << "]";
+      if (display >= ySECTION) {
+	process_outfile << " = { " << endl;
+	process_outfile << T;
+	process_outfile << "+++ }";
       }
+      process_outfile << endl;
 
-      Formula formula;
-      if (closure == clHORN || closure == clDHORN)
-	formula =
-	  strategy == sEXACT ? learnHornExact(T, A) : learnHornLarge(process_outfile, T, F, A);
-      else if (closure == clBIJUNCTIVE) {
-	formula = learn2sat(process_outfile, T, F);
-	if (formula.empty()) {
-	  process_outfile << "+++ 2SAT formula not possible for this configuration" << endl << endl;
-	  continue;
-	}
-      } else if (closure == clCNF)
-	formula = strategy == sLARGE ? learnCNFlarge(F, A) : learnCNFexact(T);
-
-      vector<size_t> names(arity);
-      if (nosection)
-	for (size_t nms = 0; nms < arity; ++nms)
-	  names[nms] = nms;
-      Formula schf = post_prod(process_outfile, latex_outfile,
-			       nosection ? names : A, F, formula);
-      if (! formula_output.empty())
-	write_formula(grps[i], grps[j], nosection ? names : A, schf);
+      process_outfile << "+++ F|_A [" << F.num_rows() << "]";
+      if (display >= ySECTION) {
+	process_outfile << " = { " << endl;
+	process_outfile << F;
+	process_outfile << "+++ }";
+      }
+      process_outfile << endl;
     }
-    disjoint = true;
-    process_outfile << endl;
+
+    Formula formula;
+    if (closure == clHORN || closure == clDHORN)
+      formula =
+	strategy == sEXACT ? learnHornExact(T, A) : learnHornLarge(process_outfile, T, F, A);
+    else if (closure == clBIJUNCTIVE) {
+      formula = learn2sat(process_outfile, T, F);
+      if (formula.empty()) {
+	process_outfile << "+++ 2SAT formula not possible for this configuration" << endl << endl;
+	return;
+      }
+    } else if (closure == clCNF)
+      formula = strategy == sLARGE ? learnCNFlarge(F, A) : learnCNFexact(T);
+
+    vector<size_t> names(arity);
+    if (nosection)
+      for (size_t nms = 0; nms < arity; ++nms)
+	names[nms] = nms;
+    Formula schf = post_prod(process_outfile, latex_outfile,
+			     nosection ? names : A, F, formula);
+    if (! formula_output.empty())
+      write_formula(grps[i], grps[j], nosection ? names : A, schf);
   }
+  disjoint = true;
+  process_outfile << endl;
 }
 
 // selected group of positive samples against all other groups together as negative samples
-void selected2all (ofstream &process_outfile, ofstream &latex_outfile, const int &i) {
+void selected2all (ostream &process_outfile, ostream &latex_outfile, const size_t i) {
   Matrix T = group_of_matrix.at(grps[i]).clone();
   Matrix F;
   vector<string> index;
@@ -531,7 +510,7 @@ void selected2all (ofstream &process_outfile, ofstream &latex_outfile, const int
       continue;
     F.reserve(F.num_rows() + group_of_matrix[grps[j]].num_rows());
     for (size_t i = 0; i < group_of_matrix[grps[j]].num_rows(); ++i)
-      F.add_row(group_of_matrix[grps[j]][i].clone());
+      F.add_row(group_of_matrix[grps[j]][i]);
     // F.insert(F.end(), group_of_matrix[grps[j]].begin(), group_of_matrix[grps[j]].end());
     index.push_back(grps[j]);
   }
@@ -622,23 +601,6 @@ void selected2all (ofstream &process_outfile, ofstream &latex_outfile, const int
   process_outfile << endl;
 }
 
-void split_action (ofstream &popr, ofstream &latpr, const int &process_id) {
-  switch (action) {
-  case aONE:
-    one2one(popr, latpr, process_id);
-    break;
-  case aALL:
-    selected2all(popr, latpr, process_id);
-    break;
-  case aSELECTED:
-    cerr << endl;
-    cerr << "*** no need to run the selected action in parallel" << endl;
-    cerr << "*** use mcp-seq to run this example" << endl;
-    exit(2);
-    break;
-  }
-}
-
 void erase_tmp () {
   const string temp_prefix = tpath + "mcp-tmp-";
   const string erase = "rm -f " + temp_prefix + "*.txt";
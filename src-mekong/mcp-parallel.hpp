@@ -35,10 +35,12 @@ using namespace std;
 void adjust ();
 void read_header ();
 void print_arg ();
-Formula learnHornLarge (ofstream &process_outfile,
+Formula learnHornLarge (ostream &process_outfile,
 			const Matrix &T, const Matrix &F, const vector<size_t> &A);
-Formula learn2sat (ofstream &process_outfile, const Matrix &T, const Matrix &F);
-void split_action (ofstream &popr, ofstream &latpr, const int &process_id);
+Formula learn2sat (ostream &process_outfile, const Matrix &T, const Matrix &F);
+void one2one (ostream &process_outfile, ostream &latex_outfile,
+	      const size_t i, const size_t j);
+void selected2all (ostream &process_outfile, ostream &latex_outfile, const size_t i);
 void crash(int signal);
 void interrupt (int signal);
 
@@ -0,0 +1,114 @@
+/**************************************************************************
+ *                                                                        *
+ *                                                                        *
+ *        Multiple Characterization Problem (MCP)                         *
+ *                                                                        *
+ * Author:   Miki Hermann                                                 *
+ * e-mail:   hermann@lix.polytechnique.fr                                 *
+ * Address:  LIX (CNRS UMR 7161), Ecole Polytechnique, France             *
+ *                                                                        *
+ * Author:   Gernot Salzer                                                *
+ * e-mail:   gernot.salzer@tuwien.ac.at                                   *
+ * Address:  Technische Universitaet Wien, Vienna, Austria                *
+ *                                                                        *
+ * Author:   César Sagaert                                                *
+ * e-mail:   cesar.sagaert@ensta-paris.fr                                 *
+ * Address:  ENSTA Paris, Palaiseau, France                               *
+ *                                                                        *
+ * Version: all                                                           *
+ *     File:    src/mcp-pool.hpp                                          *
+ *                                                                        *
+ *      Copyright (c) 2019 - 2023                                         *
+ *                                                                        *
+ * Process wide pool of worker threads.  Every thread owns a task deque;  *
+ * it serves its own deque last-in first-out and steals from the other    *
+ * deques first-in first-out when it runs dry.  A parallel loop pushes    *
+ * helper tasks which, together with the caller, claim the loop indices   *
+ * one by one, so nested loops never block a worker on foreign tasks.     *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+class ThreadPool {
+private:
+  struct Queue {
+    mutex lock;
+    deque<function<void()>> tasks;
+  };
+
+  // one parallel loop; shared with its helper tasks, which may outlive it
+  struct Loop {
+    function<void(size_t)> body;
+    size_t end;
+    size_t count;
+    atomic<size_t> next;
+    atomic<size_t> done{0};
+    atomic<bool> failed{false};
+    exception_ptr error;		// first exception thrown by body, under lock
+    mutex lock;
+    condition_variable finished;
+
+    Loop (const function<void(size_t)> &b, const size_t begin, const size_t e)
+      : body(b), end(e), count(e - begin), next(begin) {}
+    void run ();
+  };
+
+  vector<unique_ptr<Queue>> queues;	// queues[0] serves the threads outside the pool
+  vector<thread> workers;
+  mutex idle_lock;
+  condition_variable idle;
+  atomic<size_t> pending{0};
+  bool stop = false;
+
+  void push (function<void()> task);
+  bool pop (function<void()> &task);
+  void work (const size_t id);
+
+public:
+  explicit ThreadPool (size_t n);
+  ~ThreadPool ();
+  ThreadPool (const ThreadPool&) = delete;
+  ThreadPool& operator= (const ThreadPool&) = delete;
+
+  // number of threads working on a loop, the caller included
+  inline size_t size () const { return workers.size() + 1; }
+
+  // runs body(i) for all i in [begin, end); returns when all are done;
+  // if body throws, the indices not yet started are skipped and the first
+  // exception is rethrown here
+  void parallel_for (const size_t begin, const size_t end,
+		     const function<void(size_t)> &body);
+
+  // combine(...combine(combine(init, map(begin)), map(begin+1))..., map(end-1)),
+  // the maps run in parallel, the combination is done in order
+  template <typename T, typename Map, typename Combine>
+  T parallel_reduce (const size_t begin, const size_t end,
+		     T init, Map map, Combine combine) {
+    vector<T> partial(end - begin);
+    parallel_for(begin, end,
+		 [&] (const size_t i) { partial[i - begin] = map(i); });
+    for (T &p : partial)
+      init = combine(std::move(init), std::move(p));
+    return init;
+  }
+};
+
+// the pool of the process, created on first use with --threads threads
+ThreadPool& thread_pool ();
+
+//==============================================================================
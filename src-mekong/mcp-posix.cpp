@@ -22,60 +22,98 @@
  *                                                                        *
  **************************************************************************/
 
+#include <atomic>
+
 #include "mcp-posix.hpp"
 #include "mcp-common.hpp"
 #include "mcp-matrix+formula.hpp"
 #include "mcp-parallel.hpp"
-#include <thread>
+#include "mcp-pool.hpp"
 
 using namespace std;
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-void OGchunk(const Row &a, const Matrix &M, Matrix &result, int left,
-             int right) {
-  // selects tuples (rows) in M[left..right-1] above the tuple a
-  // usefull for distribution among threads
-  for (int i = left; i < right; ++i)
-    if (M[i] >= a)
-      result.add_row(M[i].clone());
+// the meet of the rows of M above the tuple a, false if there is none;
+// every block of chunkLIMIT rows folds its matches into its own running
+// minimum, and all blocks stop as soon as one minimum equals a: the rows
+// above a are all at least a, so a is then the meet
+template <typename R, typename M>
+static bool obs_geq(const R &a, const M &T, Row &meet) {
+  const size_t nrows = T.num_rows();
+  const size_t chunk = max(chunkLIMIT, 1);
+  const size_t nblocks = max<size_t>(1, (nrows + chunk - 1) / chunk);
+  vector<Row> minimum(nblocks);
+  vector<char> any_above(nblocks, false);
+  atomic<bool> reached(false);
+  thread_pool().parallel_for(0, nblocks, [&](const size_t b) {
+    Row &MIN = minimum[b];
+    const size_t last = min(nrows, (b + 1) * chunk);
+    for (size_t i = b * chunk; i < last && !reached; ++i) {
+      const auto r = T[i];
+      if (r >= a) {
+        if (any_above[b])
+          MIN.inplace_minimum(r);
+        else {
+          MIN = r.to_row();
+          any_above[b] = true;
+        }
+        if (a == MIN)
+          reached = true;
+      }
+    }
+  });
+
+  if (reached) {
+    meet = a.to_row();
+    return true;
+  }
+  bool found = false;
+  for (size_t b = 0; b < nblocks; ++b)
+    if (any_above[b]) {
+      if (found)
+        meet.inplace_minimum(minimum[b]);
+      else {
+        meet = std::move(minimum[b]);
+        found = true;
+      }
+    }
+  return found;
+}
+
+bool ObsGeq(RowSpan a, const Matrix &M, Row &meet) {
+  return obs_geq(a, M, meet);
 }
 
-Matrix gather(const Matrix &A, const Matrix &B) {
-  if (A.empty())
-    return B.clone();
-  if (B.empty())
-    return A.clone();
+bool ObsGeq(const RowView &a, const MatrixMask &M, Row &meet) {
+  return obs_geq(a, M, meet);
+}
+
+// number of blocks of at least grain indices, a few for every thread
+static inline size_t num_blocks(const size_t n, const size_t grain) {
+  return max<size_t>(1, min(n / max<size_t>(grain, 1), 4 * thread_pool().size()));
+}
 
-  Matrix C = A.clone();
-  // copy(B.begin(), B.end(), C.end());
-  for (size_t i = 0; i < B.num_rows(); ++i)
-    C.add_row(B[i].clone());
-  return C;
+void parallel_for(const size_t n, const function<void(size_t)> &body,
+                  const size_t grain) {
+  const size_t nblocks = num_blocks(n, grain);
+  thread_pool().parallel_for(0, nblocks, [&](const size_t b) {
+    for (size_t i = b * n / nblocks; i < (b + 1) * n / nblocks; ++i)
+      body(i);
+  });
 }
 
-Matrix ObsGeq(const Row &a, const Matrix &M) {
-  // selects tuples (rows) above the tuple a
-  Matrix P;
-  const int msize = M.num_rows();
-  if (msize > chunkLIMIT) {
-    int nchunks = (msize / chunkLIMIT) + (msize % chunkLIMIT > 0);
-    Matrix *chunk = new Matrix[nchunks];
-    vector<thread> chunk_threads;
-    for (int i = 0; i < nchunks; ++i)
-      chunk_threads.push_back(thread(OGchunk, ref(a), ref(M), ref(chunk[i]),
-                                     i * chunkLIMIT,
-                                     min((i + 1) * chunkLIMIT, msize)));
-    for (auto &ct : chunk_threads)
-      ct.join();
-    for (int i = 0; i < nchunks; ++i)
-      P = gather(P, chunk[i]);
-    delete[] chunk;
-  } else
-    for (size_t i = 0; i < M.num_rows(); ++i)
-      if (M[i] >= a)
-        P.add_row(M[i].clone());
-  return P;
+bool parallel_any(const size_t n, const function<bool(size_t)> &pred,
+                  const size_t grain) {
+  // once an index is found, the other blocks stop at their next index
+  atomic<bool> found(false);
+  const size_t nblocks = num_blocks(n, grain);
+  thread_pool().parallel_for(0, nblocks, [&](const size_t b) {
+    for (size_t i = b * n / nblocks; i < (b + 1) * n / nblocks && !found; ++i)
+      if (pred(i))
+        found = true;
+  });
+  return found;
 }
 
 //==================================================================================================
@@ -28,8 +28,9 @@
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-void OGchunk(const Row &a, const Matrix &M, Matrix &result, int left,
-             int right);
-Matrix gather(const Matrix &A, const Matrix &B);
+// the meet of the rows of M above the tuple a in meet, false if no row
+// is above a; the rows are scanned in blocks on the thread pool
+bool ObsGeq(RowSpan a, const Matrix &M, Row &meet);
+bool ObsGeq(const RowView &a, const MatrixMask &M, Row &meet);
 
 //==================================================================================================
@@ -256,7 +256,7 @@ void read_header () {
       vector<string> hds = split(line, ":");
       string name = hds[nOWN];
       Token tk = reverse_string.at(hds[1]);
-      integer dmax = integer(stoull(hds[2]));
+      integer dmax = read_dmax(hds[2], name);
       vector<string> elems;
       move(hds.begin()+3, hds.end(), back_inserter(elems));
       Headline hdl(name, tk, dmax, elems);
@@ -284,7 +284,7 @@ void read_matrix(Group_of_Matrix &matrix) {
       cout << "*** arity discrepancy on line " << numline << endl;
     Row temp;
     for (size_t i = 1; i < nums.size(); ++i) {
-      integer x = integer(stoull(nums.at(i)));
+      integer x = read_value(nums.at(i), numline);
       temp.push_back(x);
     }
 
@@ -341,7 +341,7 @@ void sat_test(Group_of_Matrix &matrix) {
     ctr = SENTINEL;
     size_t it_pivot = 0;
     for (size_t i = 0; i < gmtx.num_rows(); ++i) {
-      const Row &row = gmtx[i];
+      const RowSpan row = gmtx[i];
       if (pivot_file.empty())
         pdxfile << "row_" << ++ctr;
       else
@@ -384,11 +384,13 @@ void get_pivot(const Matrix &matrix) {
 //////////////////////////////////////////////////////////////////////////////
 
 int main(int argc, char **argv) {
+  read_arg(argc, argv);
+  adjust_and_open();
+  dispatch_width(headerput, argv);
+
   version += "predict";
   cerr << "+++ version = " << version << endl;
 
-  read_arg(argc, argv);
-  adjust_and_open();
   print_arg();
   get_formulas();
   read_header();
@@ -24,14 +24,21 @@
 
 #include <iostream>
 #include <fstream>
+#include <deque>
+#include <streambuf>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <chrono>
 #include <csignal>
+#include <numeric>
+#include <algorithm>
 // #include <mutex>
 #include "mcp-matrix+formula.hpp"
 #include "mcp-common.hpp"
 #include "mcp-parallel.hpp"
 #include "mcp-posix.hpp"
+#include "mcp-pool.hpp"
 
 using namespace std;
 
@@ -40,51 +47,218 @@ Arch arch = archPTHREAD;
 
 //--------------------------------------------------------------------------------------------------
 
-void thread_split (ofstream thread_outfile[], ofstream thread_latexfile[],
-		   string basename, int rank) {
-  string filename  = basename + "-" + to_string(rank) + ".txt";
-  // semaphore.lock();
-  thread_outfile[rank].open(filename);
-  // semaphore.unlock();
-  if (! thread_outfile[rank].is_open()) {
-    cerr << "+++ Cannot open output file " << filename << endl;
-    exit(2);
+// shared by the tasks and the writer, who waits here until the next
+// task in output order is done; lives in main, not destroyed by exit()
+struct Collation {
+  mutex lock;
+  condition_variable ready;
+  size_t buffered = 0;		// bytes of output kept in memory
+};
+
+// output of a task: counted against --buffer chunk by chunk as it is
+// written and kept in memory while the output of all tasks fits; once it
+// does not, what was kept and all that follows go to a temporary file
+class Spool : public streambuf {
+private:
+  Collation *col = nullptr;
+  string filename;
+  string memory;
+  ofstream file;
+  bool spilled = false;
+  char chunk[1 << 12];
+
+  // moves the chunk written so far to memory or to the file
+  void drain () {
+    const size_t size = pptr() - pbase();
+    if (size == 0)
+      return;
+    if (! spilled) {
+      bool fits;
+      {
+	lock_guard<mutex> guard(col->lock);
+	fits = col->buffered + size <= (size_t(bufferLIMIT) << 20);
+	if (fits)
+	  col->buffered += size;
+      }
+      if (fits)
+	memory.append(pbase(), size);
+      else
+	spill();
+    }
+    if (spilled)
+      file.write(pbase(), size);
+    setp(chunk, chunk + sizeof(chunk));
   }
-  thread_outfile[rank]
-    << endl
-    << "+++ Start output of thread " << rank
-    << endl << endl;
-
-  if (latex.length() > 0) {
-    string latexname = basename + "-" + to_string(rank) + ".tex";
-    thread_latexfile[rank].open(filename);
-    if (! thread_latexfile[rank].is_open()) {
-      cerr << "+++ Cannot open latex file " << latexname << endl;
+
+  void spill () {
+    file.open(filename);
+    if (! file.is_open()) {
+      cerr << "+++ Cannot open output file " << filename << endl;
       exit(2);
     }
-    thread_latexfile[rank]
-    << endl
-    << "% Start output of thread " << rank
-    << endl << endl;
+    file << memory;
+    spilled = true;
+    release();
   }
 
-  split_action(thread_outfile[rank], thread_latexfile[rank], rank);
-  
-  thread_outfile[rank] << "+++ End output of thread " << rank << endl;
-  // semaphore.lock();
-  thread_outfile[rank].close();
-  // semaphore.unlock();
-
-  if (latex.length() > 0) {
-    thread_latexfile[rank] << "% End output of thread " << rank << endl;
-    thread_latexfile[rank].close();
+protected:
+  int_type overflow (int_type c) override {
+    drain();
+    if (! traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+public:
+  void open (Collation &collation, const string &name) {
+    col = &collation;
+    filename = name;
+    setp(chunk, chunk + sizeof(chunk));
+  }
+  // drains the last chunk, once the task is done
+  void close () {
+    drain();
+    if (spilled)
+      file.close();
+  }
+  bool on_file () const { return spilled; }
+  const string &file_name () const { return filename; }
+  string_view view () const { return memory; }
+  // gives the memory back to --buffer, once the writer is done with it
+  void release () {
+    lock_guard<mutex> guard(col->lock);
+    col->buffered -= memory.size();
+    memory = string();
+  }
+  // drops the output, kept in memory or in the file
+  void discard () {
+    if (spilled)
+      remove(filename.c_str());
+    else
+      release();
+  }
+};
+
+// a unit of work for the thread pool: the positive group rank against
+// the negative group other (one to one) or against all other groups
+struct Task {
+  size_t rank;
+  size_t other;
+  size_t weight;		// |T|*|F|, estimated cost of the task
+  Spool out_spool;		// output of the task
+  Spool tex_spool;
+  ostream out{&out_spool};
+  ostream tex{&tex_spool};
+  bool done = false;
+
+  Task (size_t rank, size_t other, size_t weight)
+    : rank(rank), other(other), weight(weight) {}
+};
+
+const size_t ALLOTHERS = SIZE_MAX;
+
+string task_name (const string &basename, const Task &task) {
+  return basename + "-" + to_string(task.rank)
+    + (task.other == ALLOTHERS ? "" : "-" + to_string(task.other));
+}
+
+// the tasks in the order of their output; a deque, since a Task holds
+// streams and cannot be moved
+deque<Task> make_tasks () {
+  vector<size_t> gsize(grps.size());
+  size_t total = 0;
+  for (size_t rank = 0; rank < grps.size(); ++rank) {
+    gsize[rank] = group_of_matrix.at(grps[rank]).num_rows();
+    total += gsize[rank];
+  }
+
+  deque<Task> tasks;
+  if (action == aSELECTED) {
+    // one task, its minimal sections run on the pool themselves
+    const size_t rank = find(grps.cbegin(), grps.cend(), selected) - grps.cbegin();
+    tasks.emplace_back(rank, ALLOTHERS, gsize[rank] * (total - gsize[rank]));
+    return tasks;
+  }
+  for (size_t rank = 0; rank < grps.size(); ++rank)
+    if (action == aONE) {
+      for (size_t other = 0; other < grps.size(); ++other)
+	if (other != rank)
+	  tasks.emplace_back(rank, other, gsize[rank] * gsize[other]);
+    } else
+      tasks.emplace_back(rank, ALLOTHERS, gsize[rank] * (total - gsize[rank]));
+  return tasks;
+}
+
+void run_task (const string &basename, Task &task, Collation &col) {
+  task.out_spool.open(col, task_name(basename, task) + ".txt");
+  task.tex_spool.open(col, task_name(basename, task) + ".tex");
+  if (task.other == ALLOTHERS)
+    selected2all(task.out, task.tex, task.rank);
+  else
+    one2one(task.out, task.tex, task.rank, task.other);
+  task.out_spool.close();
+  task.tex_spool.close();
+
+  {
+    lock_guard<mutex> guard(col.lock);
+    task.done = true;
+  }
+  col.ready.notify_one();
+}
+
+// appends a temporary file to out and removes it
+void collect (ofstream &out, const string &filename) {
+  ifstream in(filename);
+  string line;
+
+  while (getline(in, line))
+    out << line << endl;
+  in.close();
+  remove(filename.c_str());
+}
+
+// writes the output of a task kept in memory or in a temporary file
+void write_spool (ofstream &out, Spool &spool) {
+  if (spool.on_file())
+    collect(out, spool.file_name());
+  else {
+    out << spool.view();
+    spool.release();
+  }
+}
+
+// the writer: streams the output of the tasks in the order of the groups,
+// every task as soon as it and all tasks before it are done
+void write_output (deque<Task> &tasks, Collation &col) {
+  for (size_t k = 0; k < tasks.size(); ) {
+    const size_t rank = tasks[k].rank;
+    outfile << endl << "+++ Start output of thread " << rank << endl << endl;
+    if (latex.length() > 0)
+      latexfile << endl << "% Start output of thread " << rank << endl << endl;
+
+    for (; k < tasks.size() && tasks[k].rank == rank; ++k) {
+      Task &task = tasks[k];
+      {
+	unique_lock<mutex> guard(col.lock);
+	col.ready.wait(guard, [&task] { return task.done; });
+      }
+      write_spool(outfile, task.out_spool);
+      if (latex.length() > 0)
+	write_spool(latexfile, task.tex_spool);
+      else
+	task.tex_spool.discard();
+    }
+
+    outfile << "+++ End output of thread " << rank << endl << endl;
+    if (latex.length() > 0)
+      latexfile << "% End output of thread " << rank << endl << endl;
   }
 }
 
 int main(int argc, char **argv)
 {
-  version += arch_strg[arch];;
-  cerr << "+++ version = " << version << endl;
   // set_terminate(crash);
   signal(SIGSEGV, crash);
   if (!debug)
@@ -92,62 +266,37 @@ int main(int argc, char **argv)
 
   read_arg(argc, argv);
   adjust();
+  dispatch_width(headerput, argv);
+
+  version += arch_strg[arch];;
+  cerr << "+++ version = " << version << endl;
   print_arg();
   read_header();
   read_matrix(group_of_matrix);
   print_matrix(group_of_matrix);
 
-  if (action == aSELECTED) {
-    cerr << endl;
-    cerr << "*** no need to run the selected action in parallel" << endl;
-    cerr << "*** use mcp-seq to run this example" << endl;
-    exit(2);
-  }
-
-  vector<thread> threads;
   const string temp_prefix = tpath + "mcp-tmp-";
   time_t start_time = time(nullptr);
   const string basename = temp_prefix + to_string(start_time);
-  ofstream *thread_outfile   = new ofstream[grps.size()];
-  ofstream *thread_latexfile = new ofstream[grps.size()];
+  deque<Task> tasks = make_tasks();
 
   // start clock
   auto clock_start = chrono::high_resolution_clock::now();
 
-  for (size_t rank = 0; rank < grps.size(); ++rank)
-    threads.push_back(thread(thread_split, thread_outfile, thread_latexfile, basename, rank));
-
-  for (auto &t : threads)
-    t.join();
-
-  delete [] thread_outfile;
-  delete [] thread_latexfile;
-
-  for (size_t rank = 0; rank < grps.size(); ++rank) {
-    string filename = basename + "-" + to_string(rank) + ".txt";
-    ifstream in(filename);
-    string line;
-
-    while (getline(in, line))
-      outfile << line << endl;
-    outfile << endl;
-    // semaphore.lock();
-    in.close();
-    remove(filename.c_str());
-    // semaphore.unlock();
-
-    if (latex.length() > 0) {
-      string latexname = basename + "-" + to_string(rank) + ".tex";
-      ifstream in(latexname);
-
-      while (getline(in, line))
-	latexfile << line << endl;
-      latexfile << endl;
-      // semaphore.lock();
-      in.close();
-      remove(latexname.c_str());
-    }
-  }
+  // largest tasks first, so that a heavy pair does not come last
+  vector<size_t> schedule(tasks.size());
+  iota(schedule.begin(), schedule.end(), 0);
+  stable_sort(schedule.begin(), schedule.end(),
+	      [&tasks] (const size_t a, const size_t b) {
+		return tasks[a].weight > tasks[b].weight;
+	      });
+  Collation col;
+  thread writer(write_output, ref(tasks), ref(col));
+  thread_pool().parallel_for(0, schedule.size(),
+			     [&] (const size_t k) {
+			       run_task(basename, tasks[schedule[k]], col);
+			     });
+  writer.join();
 
   // stop the clock
   auto clock_stop = chrono::high_resolution_clock::now();
@@ -140,7 +140,7 @@ void read_header () {
       vector<string> hds = split(line, ":");
       string name = hds[nOWN];
       Token tk = reverse_string.at(hds[1]);
-      integer dmax = integer(stoull(hds[2]));
+      integer dmax = read_dmax(hds[2], name);
       vector<string> elems;
       move(hds.begin()+3, hds.end(), back_inserter(elems));
       Headline hdl(name, tk, dmax, elems);
@@ -168,7 +168,7 @@ void read_matrix(Group_of_Matrix &matrix) {
       cout << "*** arity discrepancy on line " << numline << endl;
     Row temp;
     for (size_t i = 1; i < nums.size(); ++i) {
-      integer x = integer(stoull(nums.at(i)));
+      integer x = read_value(nums.at(i), numline);
       temp.push_back(x);
     }
     if (matrix.find(group) == matrix.end())
@@ -236,8 +236,23 @@ bool InHornClosure(const R &row, const M &matrix) {
 bool InHornClosure(const RowView &r, const MatrixMask &m) {
   return InHornClosure<RowView, MatrixMask>(r, m);
 }
-bool InHornClosure(const Row &r, const Matrix &m) {
-  return InHornClosure<Row, Matrix>(r, m);
+bool InHornClosure(RowSpan r, const Matrix &m) {
+  return InHornClosure<RowSpan, Matrix>(r, m);
+}
+
+// sequential version of the parallel loops of mcp-pthread
+void parallel_for(const size_t n, const function<void(size_t)> &body,
+                  size_t) {
+  for (size_t i = 0; i < n; ++i)
+    body(i);
+}
+
+bool parallel_any(const size_t n, const function<bool(size_t)> &pred,
+                  size_t) {
+  for (size_t i = 0; i < n; ++i)
+    if (pred(i))
+      return true;
+  return false;
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -246,36 +261,19 @@ bool InHornClosure(const Row &r, const Matrix &m) {
 // with the large strategy
 Formula learnHornLarge(const Matrix &positiveT, const Matrix &negativeF, const vector<size_t> &A) {
   Formula varphi;
-  size_t arity = positiveT.num_cols();
+  const Matrix T = meet_irreducible(positiveT);
+  const ThresholdIndex index(T);
 
   for (size_t i = 0; i < negativeF.num_rows(); ++i) {
-    const Row &f = negativeF[i];
+    const RowSpan f = negativeF[i];
     if (!sat_formula(f, varphi)) {
       continue;
     }
 
+    // the rows of T above f are found by and-ing one bitmap of the
+    // threshold index per column
     Clause c;
-    c.reserve(arity);
-    for (size_t j = 0; j < arity; ++j) {
-      Sign sign = f[j] > 0 ? lneg : lnone;
-      integer val = f[j] > 0 ? f[j] - 1 : 0;
-      Literal lit(sign, 0, val);
-      c.push_back(lit);
-    }
-    bool found = sat_clause(positiveT, c);
-    size_t j = 0;
-    Literal old;
-    while (!found && j < arity) {
-      if (f[j] < headlines[A[j]].DMAX) {
-	old = c[j];
-	c[j].sign = (Sign)(c[j].sign | lpos);
-	c[j].pval = f[j] + 1;
-	found = sat_clause(positiveT, c);
-	if (!found)
-	  c[j] = old;
-      }
-      j++;
-    }
+    const bool found = HornClause(f, T, index, A, c);
     if (!found) {
       cerr << "+++ negative example present in Horn closure of T" << endl;
       cerr << "+++ the negative culprit is '" << f << "'" << endl;
@@ -300,7 +298,7 @@ Formula learn2sat(const Matrix &positiveT, const Matrix &negativeF) {
   mesh::populate(positiveT, strip, mesh, arity);
 
   for (size_t k = 0; k < negativeF.num_rows(); ++k) {
-    const Row &f = negativeF[k];
+    const RowSpan f = negativeF[k];
 
     if (!(bucket::sat_bucket(f, bucket)))
       continue;
@@ -410,10 +408,10 @@ Formula post_prod(const vector<size_t> &A, const Matrix &F,
 // one group as positive agains one group of negative samples
 void one2one() {
   for (size_t i = 0; i < grps.size(); ++i) {
-    Matrix T = group_of_matrix.at(grps[i]).clone();
     for (size_t j = 0; j < grps.size(); ++j) {
       if (j == i)
         continue;
+      Matrix T = group_of_matrix.at(grps[i]).clone();
       Matrix F = group_of_matrix[grps[j]].clone();
 
       if (closure == clDHORN) {
@@ -515,7 +513,7 @@ void selected2all(const string &grp) {
       continue;
     F.reserve(F.num_rows() + group_of_matrix[grps[j]].num_rows());
     for (size_t i = 0; i < group_of_matrix[grps[j]].num_rows(); ++i) {
-      F.add_row(group_of_matrix[grps[j]][i].clone());
+      F.add_row(group_of_matrix[grps[j]][i]);
     }
     index.push_back(grps[j]);
   }
@@ -619,11 +617,12 @@ void one2all() {
 //////////////////////////////////////////////////////////////////////////////
 
 int main(int argc, char **argv) {
-  version += arch_strg[arch];
-  cerr << "+++ version = " << version << endl;
-
   read_arg(argc, argv);
   adjust();
+  dispatch_width(headerput, argv);
+
+  version += arch_strg[arch];
+  cerr << "+++ version = " << version << endl;
   print_arg();
   read_header();
   read_matrix(group_of_matrix);
@@ -0,0 +1,143 @@
+/**************************************************************************
+ *                                                                        *
+ *                                                                        *
+ *	         Multiple Classification Project (MCP)                    *
+ *                                                                        *
+ *	Author:   Miki Hermann                                            *
+ *	e-mail:   hermann@lix.polytechnique.fr                            *
+ *	Address:  LIX (CNRS UMR 7161), Ecole Polytechnique, France        *
+ *                                                                        *
+ *	Author: Gernot Salzer                                             *
+ *	e-mail: gernot.salzer@tuwien.ac.at                                *
+ *	Address: Technische Universitaet Wien, Vienna, Austria            *
+ *                                                                        *
+ *	Version: all                                                      *
+ *      File:    mcp-bitrow.hpp                                           *
+ *                                                                        *
+ *      Copyright (c) 2019 - 2025                                         *
+ *                                                                        *
+ * Packed Boolean row: bits stored in contiguous 64-bit words.  The word  *
+ * kernels operating on it are in mcp-bits.hpp.                           *
+ *                                                                        *
+ **************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include "mcp-bits.hpp"
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+class BitRow {
+private:
+  vector<Word> words;
+  size_t nbits = 0;
+
+  // clears the unused bits in the last word
+  inline void trim () {
+    if (nbits % WORDBITS != 0)
+      words.back() &= (Word(1) << (nbits % WORDBITS)) - 1;
+  }
+
+public:
+  // proxy to a single mutable bit
+  class reference {
+    Word *word;
+    Word mask;
+  public:
+    reference (Word *w, const size_t bit) : word(w), mask(Word(1) << bit) {}
+    inline operator bool () const { return (*word & mask) != 0; }
+    inline reference& operator= (const bool b) {
+      if (b) *word |= mask; else *word &= ~mask;
+      return *this;
+    }
+    inline reference& operator= (const reference &r) {
+      return *this = bool(r);
+    }
+  };
+
+  BitRow () = default;
+  explicit BitRow (const size_t n, const bool b = false)
+    : words(num_words(n), b ? ~Word(0) : Word(0)), nbits(n) {
+    trim();
+  }
+
+  inline size_t size () const { return nbits; }
+  inline bool empty () const { return nbits == 0; }
+  inline size_t nwords () const { return words.size(); }
+  inline const Word* data () const { return words.data(); }
+  inline Word* data () { return words.data(); }
+
+  inline bool operator[] (const size_t i) const {
+    return (words[i / WORDBITS] >> (i % WORDBITS)) & 1;
+  }
+  inline reference operator[] (const size_t i) {
+    return reference(&words[i / WORDBITS], i % WORDBITS);
+  }
+  inline bool front () const { return (*this)[0]; }
+  inline bool back () const { return (*this)[nbits-1]; }
+
+  inline void push_back (const bool b) {
+    if (nbits % WORDBITS == 0)
+      words.push_back(0);
+    if (b)
+      words.back() |= Word(1) << (nbits % WORDBITS);
+    ++nbits;
+  }
+
+  // drops the first bit, shifting the whole row one position down
+  inline void pop_front () {
+    const size_t nw = words.size();
+    for (size_t w = 0; w + 1 < nw; ++w)
+      words[w] = (words[w] >> 1) | (words[w+1] << (WORDBITS-1));
+    words[nw-1] >>= 1;
+    if (--nbits % WORDBITS == 0)
+      words.pop_back();
+  }
+
+  inline void resize (const size_t n) {
+    words.resize(num_words(n), 0);
+    nbits = n;
+    trim();
+  }
+
+  inline void flip () {
+    for (Word &w : words)
+      w = ~w;
+    trim();
+  }
+
+  // meet (coordinate wise minimum) with another row of the same size
+  inline BitRow& operator&= (const BitRow &other) {
+    bits_and(words.data(), words.data(), other.words.data(), words.size());
+    return *this;
+  }
+
+  inline bool operator== (const BitRow &other) const {
+    return nbits == other.nbits && words == other.words;
+  }
+  inline bool operator!= (const BitRow &other) const {
+    return ! (*this == other);
+  }
+
+  // lexicographic order, the same as on deque<bool>
+  inline bool operator< (const BitRow &other) const {
+    const size_t common = nbits < other.nbits ? nbits : other.nbits;
+    const size_t nw = num_words(common);
+    for (size_t w = 0; w < nw; ++w) {
+      Word diff = words[w] ^ other.words[w];
+      if (w == nw-1 && common % WORDBITS != 0)
+	diff &= (Word(1) << (common % WORDBITS)) - 1;
+      if (diff != 0)
+	return (other.words[w] & diff & (~diff + 1)) != 0;
+    }
+    return nbits < other.nbits;
+  }
+  inline bool operator<= (const BitRow &other) const {
+    return ! (other < *this);
+  }
+};
+
+//==============================================================================
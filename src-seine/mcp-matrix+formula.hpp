@@ -28,8 +28,10 @@
 #include <map>
 #include <boost/dynamic_bitset.hpp>
 #include <numeric>
+#include "mcp-bitrow.hpp"
+#include "mcp-bitmatrix.hpp"
 
-#define GLOBAL_VERSION "1.04f-seine-"
+#define GLOBAL_VERSION "1.04g-seine-"
 #define NOARCH_VERSION "1.04f-noarch-"
 
 using namespace std;
@@ -40,10 +42,11 @@ extern string version;
 extern const string print_strg[];
 extern const string display_strg[];
 
-typedef deque<bool> Row;
+// typedef deque<bool> Row;
 // typedef boost::dynamic_bitset<> Row;
+typedef BitRow Row;
 typedef deque<Row> Matrix;
-typedef map<string, Matrix> Group_of_Matrix;
+typedef map<string, BitMatrix> Group_of_Matrix;
 extern Group_of_Matrix group_of_matrix;
 extern vector<string> grps;
 
@@ -95,6 +98,14 @@ bool sat_clause (const Row &tuple, const Clause &clause);
 bool sat_formula (const Row &tuple, const Formula &formula);
 ostream& operator<< (ostream &output, const Row &row);
 ostream& operator<< (ostream &output, const Matrix &M);
+ostream& operator<< (ostream &output, const RowView &row);
+ostream& operator<< (ostream &output, const BitMatrix &M);
+void pack (const Row &row, Word *words);
+Row unpack (const Word *words, const size_t nbits);
+BitMatrix pack (const Matrix &M);
+BitMatrix pack (const Matrix &M, const size_t ncols);
+Matrix unpack (const BitMatrix &M);
+void push_back (BitMatrix &M, const Row &row);
 // void push_front (Row &row1, const bool b);
 void push_front (Row &row1, const Row &row2);
 // bool front (const Row &row);
@@ -33,6 +33,7 @@
 #include "mcp-matrix+formula.hpp"
 #include "mcp-common.hpp"
 #include "mcp-parallel.hpp"
+#include "mcp-pool.hpp"
 
 using namespace std;
 
@@ -121,6 +122,10 @@ void print_arg () {
   outfile << "@@@ var. offset   = " << offset << endl;
   if (arch != archMPI)
     outfile << "@@@ chunk limit   = " << chunkLIMIT << endl;
+  if (arch == archPTHREAD) {
+    outfile << "@@@ threads       = " << thread_pool().size() << endl;
+    outfile << "@@@ buffer limit  = " << bufferLIMIT << " MB" << endl;
+  }
   if (arch != archPTHREAD)
     outfile << "@@@ proc.num. fit = " << (np_fit ? "yes" : "no") << endl;
   outfile << "@@@ print matrix  = " << display_strg[display]
@@ -187,7 +192,7 @@ void read_matrix (Group_of_Matrix &matrix) {
       outfile << "*** arity discrepancy on line " << numline << endl;
 
     // if (cluster <= SENTINEL)
-      matrix[group].push_back(temp);
+      push_back(matrix[group], temp);
     // else {
     //   gqueue.push_back(group);
     //   batch.push_back(temp);
@@ -217,7 +222,7 @@ void print_matrix (const Group_of_Matrix &matrix) {
   for (auto group = matrix.cbegin(); group != matrix.cend(); ++group) {
     outfile << "+++ Group " << group->first;
     grps.push_back(group->first);
-    Matrix gmtx = group->second;
+    const BitMatrix &gmtx = group->second;
     outfile << " [" << gmtx.size() << "]:" << endl;
     if (display == yPEEK || display == ySHOW)
       outfile << gmtx << endl;
@@ -238,40 +243,37 @@ void print_matrix (const Group_of_Matrix &matrix) {
 
 // learn a Horn clause from positive examples T and negative examples F
 // with the large strategy
-Formula learnHornLarge (ofstream &process_outfile,
+Formula learnHornLarge (ostream &process_outfile,
 			const Matrix &T, const Matrix &F) {
   Formula H;
-
-  for (const Row &f : F) {
-    Clause clause;
-    for (size_t i = 0; i < f.size(); ++i)
-      clause += f[i] ? lneg : lnone;
-    bool found = satisfied_by(clause, T);
-    size_t i = 0;
-    while (!found && i < f.size()) {
-      if (! f[i]) {
-	clause[i] = lpos;
-	found = satisfied_by(clause, T);
-	if (!found)
-	  clause[i] = lnone;
-      }
-      i++;
-    }
-    if (!found)
-      process_outfile << "+++ WARNING: vector " << f << " not elminated" << endl;
+  if (F.empty())
+    return H;
+
+  // one closure query per f on the column index of T;
+  // every f is eliminated on its own, the results are collected in order
+  const BitMatrix Tp = meet_irreducible(pack(T, F[0].size()));
+  const BitMatrix Tc = Tp.transpose();
+  const BitMatrix Fp = pack(F, F[0].size());
+  const MatrixMask Tm(Tp, &Tc);
+  vector<Clause> clauses(F.size());
+  vector<char> found(F.size(), false);
+  parallel_for(F.size(),
+	       [&] (const size_t k) { found[k] = HornClause(Fp[k], Tm, clauses[k]); });
+
+  for (size_t k = 0; k < F.size(); ++k)
+    if (!found[k])
+      process_outfile << "+++ WARNING: vector " << F[k] << " not elminated" << endl;
     else
-      H.push_back(clause);
-  }
+      H.push_back(std::move(clauses[k]));
 
   cook(H);
   return H;
 }
 
-Formula learn2sat (ofstream &process_outfile, const Matrix &T, const Matrix &F) {
+Formula learn2sat (ostream &process_outfile, const Matrix &T, const Matrix &F) {
   // learn a bijunctive clause from positive examples T and negative examples F
   Formula B;
   const size_t lngt = T[0].size();
-  const Literal literals[] = {lpos, lneg};
 
   // Put here the production of a bijunctive formula
   // Is it necessary to generate the majority closure?
@@ -289,27 +291,9 @@ Formula learn2sat (ofstream &process_outfile, const Matrix &T, const Matrix &F)
       return B;
     }
 
-    for (size_t j = 0; j < lngt; ++j) {
-      Clause clause(lngt, lnone);
-      clause[j] = lpos;
-      if (satisfied_by(clause, T))
-	B.push_back(clause);
-      clause[j] = lneg;
-      if (satisfied_by(clause, T))
-	B.push_back(clause);
-    }
-
-    for (int j1 = 0; j1 < lngt-1; ++j1)
-      for (int j2 = j1+1; j2 < lngt; ++j2)
-	for (const Literal lit1 : literals) {
-	  Clause clause(lngt, lnone);
-	  clause[j1] = lit1;
-	  for (const Literal lit2 : literals) {
-	    clause[j2] = lit2;
-	    if (satisfied_by(clause, T))
-	      B.push_back(clause);
-	  }
-	}
+    // all clauses of one or two literals satisfied by T,
+    // read off the column bitmaps of T
+    B = bijunctive_clauses(T);
 
     for (const Row &f : F)
       if (sat_formula(f, B))
@@ -319,33 +303,10 @@ Formula learn2sat (ofstream &process_outfile, const Matrix &T, const Matrix &F)
     B = primality(B, T);
   } else if (strategy == sLARGE) {
     
-    for (size_t j = 0; j < lngt; ++j) {
-      Clause clause(lngt, lnone);
+    // the clauses of one or two literals satisfied by T and falsified
+    // by some tuple in F, read off the column bitmaps of T and F
+    B = bijunctive_clauses(T, &F);
 
-      clause[j] = lpos;
-      if (! satisfied_by(clause, F)
-	  && satisfied_by(clause, T))
-	B.push_back(clause);
-
-      clause[j] = lneg;
-      if (! satisfied_by(clause, F)
-	  && satisfied_by(clause, T))
-	B.push_back(clause);
-    }
-
-    for (int j1 = 0; j1 < lngt-1; ++j1)
-      for (int j2 = j1+1; j2 < lngt; ++j2)
-	for (const Literal lit1 : literals) {
-	  Clause clause(lngt, lnone);
-	  clause[j1] = lit1;
-	  for (const Literal lit2 : literals) {
-	    clause[j2] = lit2;
-	    if (! satisfied_by(clause, F)
-		&& satisfied_by(clause, T))
-	      B.push_back(clause);
-	  }
-	}
-    
     for (const Row &t : T)
       if (! sat_formula(t, B))
     	process_outfile << "WARNING: vector " << t
@@ -359,7 +320,7 @@ Formula learn2sat (ofstream &process_outfile, const Matrix &T, const Matrix &F)
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-Formula post_prod(ofstream &process_outfile, ofstream &latex_outfile,
+Formula post_prod(ostream &process_outfile, ostream &latex_outfile,
 	       const vector<size_t> &A, const Matrix &F, const Formula &formula) {
   Formula schf;
   if (setcover) {
@@ -388,7 +349,7 @@ Formula post_prod(ofstream &process_outfile, ofstream &latex_outfile,
   return schf;
 }
 
-Formula post_prod(ofstream &process_outfile, ofstream &latex_outfile,
+Formula post_prod(ostream &process_outfile, ostream &latex_outfile,
 		  const Matrix &F, const Formula &formula) {
   vector<size_t> names;
   for (size_t i = 0; i < formula[0].size(); ++i)
@@ -399,112 +360,110 @@ Formula post_prod(ofstream &process_outfile, ofstream &latex_outfile,
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-void one2one (ofstream &process_outfile, ofstream &latex_outfile, const int &i) {
-  // one group as positive agains one group of negative examples
+void one2one (ostream &process_outfile, ostream &latex_outfile,
+	      const size_t i, const size_t j) {
+  // group i as positive against group j of negative examples
 
-  Matrix T = group_of_matrix[grps[i]];
-  for (size_t j = 0; j < grps.size(); ++j) {
-    if (j == i) continue;
-    Matrix F = group_of_matrix[grps[j]];
+  Matrix T = unpack(group_of_matrix.at(grps[i]));
+  Matrix F = unpack(group_of_matrix.at(grps[j]));
 
-    if (closure == clDHORN) {
-      process_outfile << "+++ swapping polarity of vectors and treating swapped vectors as Horn" << endl;
-      polswap_matrix(T);
-      polswap_matrix(F);
-    }
+  if (closure == clDHORN) {
+    process_outfile << "+++ swapping polarity of vectors and treating swapped vectors as Horn" << endl;
+    polswap_matrix(T);
+    polswap_matrix(F);
+  }
 
-    Row sect = minsect(T, F);
-    if (nosection)
-      process_outfile << "+++ Groups ";
-    else
-      process_outfile << "+++ Section of groups ";
-    process_outfile << "T=" << grps[i] << " and F=" << grps[j] << ":" << endl;
-    // process_outfile << "    " << sect << endl;
-    
-    if (!disjoint) {
-      process_outfile << "+++ Matrices <T> and F are not disjoint, therefore I cannot infer a formula"
-		      << endl << endl;
-    } else {
-      vector<size_t> A;
-      if (!nosection) {
-	size_t hw = hamming_weight(sect);
-	process_outfile << "+++ Relevant variables [" << hw << "]: ";
-	for (size_t k = 0; k < sect.size(); ++k)
-	  if (sect[k]) {
-	    A.push_back(k);
-	    if (varswitch) {
-	      // vector<string> new_names = split(varnames[k], ":");
-	      process_outfile << varnames[k][nOWN];
-	    } else
-	      process_outfile << varid << to_string(offset+k);
-	    process_outfile << " ";
-	  }
-	process_outfile << endl;
-	process_outfile << "+++ A [" << hw << "] = {";
-	for (const size_t &coord : A)
-	  process_outfile << offset + coord << " ";
-	process_outfile << "}" << endl;
-	T = restrict(sect, T);
-	F = restrict(sect, F);
-
-	process_outfile << "+++ T|_A [" << T.size() << "]";
-	if (display >= ySECTION) {
-	  process_outfile << " = { " << endl;
-	  process_outfile << T;
-	  process_outfile << "+++ }";
+  Row sect = minsect(T, F);
+  if (nosection)
+    process_outfile << "+++ Groups ";
+  else
+    process_outfile << "+++ Section of groups ";
+  process_outfile << "T=" << grps[i] << " and F=" << grps[j] << ":" << endl;
+  // process_outfile << "    " << sect << endl;
+  
+  if (!disjoint) {
+    process_outfile << "+++ Matrices <T> and F are not disjoint, therefore I cannot infer a formula"
+		    << endl << endl;
+  } else {
+    vector<size_t> A;
+    if (!nosection) {
+      size_t hw = hamming_weight(sect);
+      process_outfile << "+++ Relevant variables [" << hw << "]: ";
+      for (size_t k = 0; k < sect.size(); ++k)
+	if (sect[k]) {
+	  A.push_back(k);
+	  if (varswitch) {
+	    // vector<string> new_names = split(varnames[k], ":");
+	    process_outfile << varnames[k][nOWN];
+	  } else
+	    process_outfile << varid << to_string(offset+k);
+	  process_outfile << " ";
 	}
-	process_outfile << endl;
+      process_outfile << endl;
+      process_outfile << "+++ A [" << hw << "] = {";
+      for (const size_t &coord : A)
+	process_outfile << offset + coord << " ";
+      process_outfile << "}" << endl;
+      T = restrict(sect, T);
+      F = restrict(sect, F);
 
-	process_outfile << "+++ F|_A [" << F.size() << "]";
-	if (display >= ySECTION) {
-	  process_outfile << " = { " << endl;
-	  process_outfile << F;
-	  process_outfile << "+++ }";
-	}
-	process_outfile << endl;
+      process_outfile << "+++ T|_A [" << T.size() << "]";
+      if (display >= ySECTION) {
+	process_outfile << " = { " << endl;
+	process_outfile << T;
+	process_outfile << "+++ }";
+      }
+      process_outfile << endl;
+
+      process_outfile << "+++ F|_A [" << F.size() << "]";
+      if (display >= ySECTION) {
+	process_outfile << " = { " << endl;
+	process_outfile << F;
+	process_outfile << "+++ }";
       }
+      process_outfile << endl;
+    }
 
-      Formula formula;
-      if (closure == clHORN || closure == clDHORN)
-	formula =  strategy == sEXACT
-	  ? learnHornExact(T)
-	  : learnHornLarge(process_outfile, T, F);
-      else if (closure == clBIJUNCTIVE) {
-	formula = learn2sat(process_outfile, T, F);
-	if (formula.empty()) {
-	  process_outfile << "+++ 2SAT formula not possible for this configuration" << endl << endl;
-	  continue;
-	}
+    Formula formula;
+    if (closure == clHORN || closure == clDHORN)
+      formula =  strategy == sEXACT
+	? learnHornExact(T)
+	: learnHornLarge(process_outfile, T, F);
+    else if (closure == clBIJUNCTIVE) {
+      formula = learn2sat(process_outfile, T, F);
+      if (formula.empty()) {
+	process_outfile << "+++ 2SAT formula not possible for this configuration" << endl << endl;
+	return;
       }
-      else if (closure == clCNF)
-	formula = strategy == sLARGE
-	  ? learnCNFlarge(F)
-	  : learnCNFexact(T);
-
-      vector<size_t> names(arity);
-      if (nosection)
-	for (size_t nms = 0; nms < arity; ++nms)
-	  names[nms] = nms;
-      Formula schf = post_prod(process_outfile, latex_outfile,
-			       nosection ? names : A, F, formula);
-      if (! formula_output.empty())
-	write_formula(grps[i], grps[j], nosection ? names : A, schf);
     }
-    disjoint = true;
-    process_outfile << endl;
+    else if (closure == clCNF)
+      formula = strategy == sLARGE
+	? learnCNFlarge(F)
+	: learnCNFexact(T);
+
+    vector<size_t> names(arity);
+    if (nosection)
+      for (size_t nms = 0; nms < arity; ++nms)
+	names[nms] = nms;
+    Formula schf = post_prod(process_outfile, latex_outfile,
+			     nosection ? names : A, F, formula);
+    if (! formula_output.empty())
+      write_formula(grps[i], grps[j], nosection ? names : A, schf);
   }
-  // }
+  disjoint = true;
+  process_outfile << endl;
 }
 
-void selected2all (ofstream &process_outfile, ofstream &latex_outfile, const int &i) {
+void selected2all (ostream &process_outfile, ostream &latex_outfile, const size_t i) {
   // selected group of positive exaples against all other groups together as negative examples
   
-  Matrix T = group_of_matrix[grps[i]];
+  Matrix T = unpack(group_of_matrix.at(grps[i]));
   Matrix F;
   vector<string> index;
   for (size_t j = 0; j < grps.size(); ++j) {
     if (j == i) continue;
-    F.insert(F.end(), group_of_matrix[grps[j]].begin(), group_of_matrix[grps[j]].end());
+    const Matrix G = unpack(group_of_matrix.at(grps[j]));
+    F.insert(F.end(), G.cbegin(), G.cend());
     index.push_back(grps[j]);
   }
   sort(index.begin(), index.end());
@@ -599,23 +558,6 @@ void selected2all (ofstream &process_outfile, ofstream &latex_outfile, const int
   // }
 }
 
-void split_action (ofstream &popr, ofstream &latpr, const int &process_id) {
-  switch (action) {
-  case aONE:
-    one2one(popr, latpr, process_id);
-    break;
-  case aALL:
-    selected2all(popr, latpr, process_id);
-    break;
-  case aSELECTED:
-    cerr << endl;
-    cerr << "*** no need to run the selected action in parallel" << endl;
-    cerr << "*** use mcp-seq to run this example" << endl;
-    exit(2);
-    break;
-  }
-}
-
 // terminal handler: we erase the temporary files in case of a crash
 void crash (int signal) {
   const string temp_prefix = tpath + "mcp-tmp-";
@@ -0,0 +1,152 @@
+/**************************************************************************
+ *                                                                        *
+ *                                                                        *
+ *	         Multiple Classification Project (MCP)                    *
+ *                                                                        *
+ *	Author:   Miki Hermann                                            *
+ *	e-mail:   hermann@lix.polytechnique.fr                            *
+ *	Address:  LIX (CNRS UMR 7161), Ecole Polytechnique, France        *
+ *                                                                        *
+ *	Author: Gernot Salzer                                             *
+ *	e-mail: gernot.salzer@tuwien.ac.at                                *
+ *	Address: Technische Universitaet Wien, Vienna, Austria            *
+ *                                                                        *
+ *	Version: parallel with POSIX threads                              *
+ *      File:    mcp-pool.cpp                                             *
+ *                                                                        *
+ *      Copyright (c) 2019 - 2025                                         *
+ *                                                                        *
+ * Process wide pool of worker threads.  Every thread owns a task deque;  *
+ * it serves its own deque last-in first-out and steals from the other    *
+ * deques first-in first-out when it runs dry.  A parallel loop pushes    *
+ * helper tasks which, together with the caller, claim the loop indices   *
+ * one by one, so nested loops never block a worker on foreign tasks.     *
+ *                                                                        *
+ **************************************************************************/
+
+#include "mcp-common.hpp"
+#include "mcp-pool.hpp"
+
+using namespace std;
+
+// index of the deque of the current thread, 0 outside the pool
+static thread_local size_t worker_id = 0;
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+void ThreadPool::Loop::run () {
+  for (size_t i = next++; i < end; i = next++) {
+    // an index is counted even if skipped or failed, so the caller wakes up
+    if (! failed)
+      try {
+	body(i);
+      } catch (...) {
+	lock_guard<mutex> guard(lock);
+	if (! error)
+	  error = current_exception();
+	failed = true;
+      }
+    if (++done == count) {
+      lock_guard<mutex> guard(lock);
+      finished.notify_all();
+    }
+  }
+}
+
+ThreadPool::ThreadPool (size_t n) {
+  if (n == 0)
+    n = max(thread::hardware_concurrency(), 1u);
+  for (size_t id = 0; id < n; ++id)
+    queues.push_back(make_unique<Queue>());
+  for (size_t id = 1; id < n; ++id)
+    workers.push_back(thread(&ThreadPool::work, this, id));
+}
+
+ThreadPool::~ThreadPool () {
+  {
+    lock_guard<mutex> guard(idle_lock);
+    stop = true;
+  }
+  idle.notify_all();
+  for (thread &w : workers)
+    w.join();
+}
+
+void ThreadPool::push (function<void()> task) {
+  {
+    lock_guard<mutex> guard(queues[worker_id]->lock);
+    queues[worker_id]->tasks.push_back(std::move(task));
+  }
+  ++pending;
+  {
+    lock_guard<mutex> guard(idle_lock);
+  }
+  idle.notify_one();
+}
+
+bool ThreadPool::pop (function<void()> &task) {
+  // own deque from the back, the others from the front
+  for (size_t k = 0; k < queues.size(); ++k) {
+    Queue &q = *queues[(worker_id + k) % queues.size()];
+    lock_guard<mutex> guard(q.lock);
+    if (! q.tasks.empty()) {
+      if (k == 0) {
+	task = std::move(q.tasks.back());
+	q.tasks.pop_back();
+      } else {
+	task = std::move(q.tasks.front());
+	q.tasks.pop_front();
+      }
+      --pending;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::work (const size_t id) {
+  worker_id = id;
+  function<void()> task;
+  while (true) {
+    if (pop(task)) {
+      task();
+      task = nullptr;
+      continue;
+    }
+    unique_lock<mutex> guard(idle_lock);
+    idle.wait(guard, [this] { return stop || pending > 0; });
+    if (stop)
+      return;
+  }
+}
+
+void ThreadPool::parallel_for (const size_t begin, const size_t end,
+			       const function<void(size_t)> &body) {
+  if (begin >= end)
+    return;
+  const size_t helpers = min(end - begin - 1, workers.size());
+  if (helpers == 0) {
+    for (size_t i = begin; i < end; ++i)
+      body(i);
+    return;
+  }
+
+  // the caller only works on its own loop: once the indices are gone
+  // it waits, while helpers still queued find nothing left to do
+  auto loop = make_shared<Loop>(body, begin, end);
+  for (size_t h = 0; h < helpers; ++h)
+    push([loop] { loop->run(); });
+  loop->run();
+  unique_lock<mutex> guard(loop->lock);
+  loop->finished.wait(guard, [&loop] { return loop->done == loop->count; });
+  if (loop->error)
+    rethrow_exception(loop->error);
+}
+
+ThreadPool& thread_pool () {
+  // never destroyed: exit() may be called from inside a worker
+  static ThreadPool *pool = new ThreadPool(nthreads);
+  return *pool;
+}
+
+//==================================================================================================
@@ -174,7 +174,7 @@ void read_matrix (Group_of_Matrix &matrix) {
       cout << "*** arity discrepancy on line " << numline << endl;
 
     // if (cluster <= SENTINEL)
-    matrix[group].push_back(temp);
+    push_back(matrix[group], temp);
     // else {
     //   gqueue.push_back(group);
     //   batch.push_back(temp);
@@ -204,7 +204,7 @@ void print_matrix (const Group_of_Matrix &matrix) {
   for (auto group = matrix.cbegin(); group != matrix.cend(); ++group) {
     cout << "+++ Group " << group->first;
     grps.push_back(group->first);
-    auto gmtx = group->second;
+    const BitMatrix &gmtx = group->second;
     cout << " [" << gmtx.size() << "]:" << endl;
     if (display == yPEEK || display == ySHOW)
       cout << gmtx << endl;
@@ -223,41 +223,67 @@ void print_matrix (const Group_of_Matrix &matrix) {
   cout << endl;
 }
 
-unique_ptr<Row> ObsGeq (const Row &a, const Matrix &M) {
-  // selects tuples (rows) above the tuple a
-  unique_ptr<Row> P;
-  for (const Row &row : M)
-    if (row >= a)
-      P = make_unique<Row>(P == nullptr ? row : Min(*P, row));
+unique_ptr<Row> ObsGeq (const RowView &a, const MatrixMask &T) {
+  // computes the minimum of the tuples (rows) of T above the tuple a,
+  // on the visible columns of T, using the column index C of T:
+  // the rows above a are the intersection of the columns where a is 1,
+  // the minimum is 1 on a and on every column containing all these rows
+  const BitMatrix &C = *T.column_index();
+  const Word *mask = T.mask();
+  const size_t nw = C.row_stride();
+  vector<Word> above(nw);
+  bits_ones(above.data(), C.num_cols());
+  for (size_t w = 0; w < a.nwords(); ++w)
+    for (Word bits = a.data()[w] & mask[w]; bits != 0; bits &= bits - 1)
+      bits_and(above.data(), above.data(), C.row(w * WORDBITS + ctz64(bits)), nw);
+  if (! bits_any(above.data(), nw))
+    return nullptr;
+
+  unique_ptr<Row> P = make_unique<Row>(a.size());
+  for (size_t w = 0; w < a.nwords(); ++w) {
+    for (Word bits = a.data()[w] & mask[w]; bits != 0; bits &= bits - 1)
+      (*P)[w * WORDBITS + ctz64(bits)] = true;
+    for (Word bits = ~a.data()[w] & mask[w]; bits != 0; bits &= bits - 1) {
+      const size_t j = w * WORDBITS + ctz64(bits);
+      if (bits_geq(C.row(j), above.data(), nw))
+	(*P)[j] = true;
+    }
+  }
   return P;
 }
 
+// sequential version of the parallel loops of mcp-pthread
+void parallel_for (const size_t n, const function<void(size_t)> &body, size_t) {
+  for (size_t i = 0; i < n; ++i)
+    body(i);
+}
+
+bool parallel_any (const size_t n, const function<bool(size_t)> &pred, size_t) {
+  for (size_t i = 0; i < n; ++i)
+    if (pred(i))
+      return true;
+  return false;
+}
+
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
 Formula learnHornLarge (const Matrix &T, const Matrix &F) {
   // learn a Horn clause from positive examples T and negative examples F
-  // with the large strategy
+  // with the large strategy: one closure query per f on the column index of T
   Formula H;
-
-  for (const Row &f : F) {
+  if (F.empty())
+    return H;
+  const BitMatrix Tp = meet_irreducible(pack(T, F[0].size()));
+  const BitMatrix Tc = Tp.transpose();
+  const BitMatrix Fp = pack(F, F[0].size());
+  const MatrixMask Tm(Tp, &Tc);
+
+  for (size_t k = 0; k < Fp.size(); ++k) {
     Clause clause;			// Clause type is a string
-    for (size_t i = 0; i < f.size(); ++i)
-      clause += f[i] ? lneg : lnone;
-    bool found = satisfied_by(clause, T);
-    size_t i = 0;
-    while (!found && i < f.size()) {
-      if (! f[i]) {
-	clause[i] = lpos;
-	found = satisfied_by(clause, T);
-	if (!found)
-	  clause[i] = lnone;
-      }
-      i++;
-    }
-    if (!found)
-      cout << "+++ WARNING: vector " << f << " not elminated" << endl;
-    else
+    if (HornClause(Fp[k], Tm, clause))
       H.push_back(clause);
+    else
+      cout << "+++ WARNING: vector " << F[k] << " not elminated" << endl;
   }
 
   if (debug)
@@ -272,7 +298,6 @@ Formula learn2sat (const Matrix &T, const Matrix &F) {
   // learn a bijunctive clause from positive examples T and negative examples F
   Formula B;
   const size_t lngt = T[0].size();
-  const Literal literals[] = {lpos, lneg};
 
   // Put here the production of a bijunctive formula
   // Is it necessary to generate the majority closure?
@@ -290,27 +315,9 @@ Formula learn2sat (const Matrix &T, const Matrix &F) {
       return B;
     }
 
-    for (size_t j = 0; j < lngt; ++j) {
-      Clause clause(lngt, lnone);
-      clause[j] = lpos;
-      if (satisfied_by(clause, T))
-	B.push_back(clause);
-      clause[j] = lneg;
-      if (satisfied_by(clause, T))
-	B.push_back(clause);
-    }
-
-    for (int j1 = 0; j1 < lngt-1; ++j1)
-      for (int j2 = j1+1; j2 < lngt; ++j2)
-	for (const Literal lit1 : literals) {
-	  Clause clause(lngt, lnone);
-	  clause[j1] = lit1;
-	  for (const Literal lit2 : literals) {
-	    clause[j2] = lit2;
-	    if (satisfied_by(clause, T))
-	      B.push_back(clause);
-	  }
-	}
+    // all clauses of one or two literals satisfied by T,
+    // read off the column bitmaps of T
+    B = bijunctive_clauses(T);
 
     for (const Row &f : F)
       if (sat_formula(f, B))
@@ -320,33 +327,10 @@ Formula learn2sat (const Matrix &T, const Matrix &F) {
     B = primality(B, T);
   } else if (strategy == sLARGE) {
     
-    for (size_t j = 0; j < lngt; ++j) {
-      Clause clause(lngt, lnone);
-
-      clause[j] = lpos;
-      if (! satisfied_by(clause, F)
-	  && satisfied_by(clause, T))
-	B.push_back(clause);
+    // the clauses of one or two literals satisfied by T and falsified
+    // by some tuple in F, read off the column bitmaps of T and F
+    B = bijunctive_clauses(T, &F);
 
-      clause[j] = lneg;
-      if (! satisfied_by(clause, F)
-	  && satisfied_by(clause, T))
-	B.push_back(clause);
-    }
-
-    for (int j1 = 0; j1 < lngt-1; ++j1)
-      for (int j2 = j1+1; j2 < lngt; ++j2)
-	for (const Literal lit1 : literals) {
-	  Clause clause(lngt, lnone);
-	  clause[j1] = lit1;
-	  for (const Literal lit2 : literals) {
-	    clause[j2] = lit2;
-	    if (! satisfied_by(clause, F)
-		&& satisfied_by(clause, T))
-	      B.push_back(clause);
-	  }
-	}
-    
     for (const Row &t : T)
       if (! sat_formula(t, B))
     	cout << "WARNING: vector " << t
@@ -423,10 +407,10 @@ void one2one () {
   // one group as positive agains one group of negative examples
 
   for (size_t i = 0; i < grps.size(); ++i) {
-    Matrix T = group_of_matrix[grps[i]];
     for (size_t j = 0; j < grps.size(); ++j) {
       if (j == i) continue;
-      Matrix F = group_of_matrix[grps[j]];
+      Matrix T = unpack(group_of_matrix[grps[i]]);
+      Matrix F = unpack(group_of_matrix[grps[j]]);
 
       if (closure == clDHORN) {
 	cout << "+++ swapping polarity of vectors and treating swapped vectors as Horn" << endl;
@@ -520,14 +504,14 @@ void one2one () {
 // together as negative examples
 void selected2all (const string &grp) {
 
-  Matrix T = group_of_matrix[grp];
+  Matrix T = unpack(group_of_matrix[grp]);
   Matrix F;
   vector<string> index;
   for (size_t j = 0; j < grps.size(); ++j) {
     if (grps[j] == grp)
       continue;
-    F.insert(F.end(),
-	     group_of_matrix[grps[j]].begin(), group_of_matrix[grps[j]].end());
+    const Matrix G = unpack(group_of_matrix[grps[j]]);
+    F.insert(F.end(), G.cbegin(), G.cend());
     index.push_back(grps[j]);
   }
   sort(index.begin(), index.end());
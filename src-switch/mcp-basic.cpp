@@ -42,6 +42,10 @@ string version_string[] = {
   "danube",
   "mekong"
 };
+string width_string[] = {
+  "8",
+  "32"
+};
 
 string version;		// real version
 // VERSION map VERSION[module][version]
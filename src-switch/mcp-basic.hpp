@@ -46,6 +46,11 @@ enum Version : short {
 };
 extern string version_string[];
 
+// mekong is also built for 8 and 32-bit domain values, as
+// mcp-<module>-mekong8 and mcp-<module>-mekong32; every module but trans
+// may exec one of them, so they are verified along with mcp-<module>-mekong
+extern string width_string[2];
+
 extern string version;		// real version
 // VERSION map VERSION[module][version]
 //  module,    version, sha3
@@ -78,6 +78,17 @@ string join (const vector<string> &arglist) {
   return arg_string;
 }
 
+// stops unless the binary file whis has the SHA3 recorded for version
+void verify (const string &binary, const string &whis, const string &mv_version) {
+  const auto entry = VERSION.at(module).find(mv_version);
+  if (entry == VERSION.at(module).end() || sha3_file(whis) != entry->second) {
+    cerr << "+++ binary file " << binary << " compromised" << endl
+	 << "... recompile the binaries for " << version << " version"
+	 << endl;
+    exit(2);
+  }
+}
+
 int main (int argc, char **argv) {
   read_arg(argc, argv);
   set_version();
@@ -89,15 +100,19 @@ int main (int argc, char **argv) {
     cerr << "+++ binary file " << whis << " not found" << endl;
     exit(2);
   }
-  const string sha3 = sha3_file(whis);
-  if (sha3 != VERSION.at(module).at(version)) {
-    cerr << "+++ binary file " << binary << " compromised" << endl
-	 << "... recompile the binaries for " << version << " version"
-	 << endl;
-    exit(2);
-  } else {
-    const string system_call(binary + " " + arg_string);
-    int sysout = system(system_call.c_str());
-    return sysout;
-  }
+  verify(binary, whis, version);
+  // the mekong binary may exec its 8 or 32-bit sibling, see dispatch_width
+  if (version == version_string[mekong] && module != module_string[trans])
+    for (const string &width : width_string) {
+      const string sibling(binary + width);
+      if (search_file(sibling, whis) == string::npos) {
+	cerr << "+++ binary file " << whis << " not found" << endl;
+	exit(2);
+      }
+      verify(sibling, whis, version + width);
+    }
+
+  const string system_call(binary + " " + arg_string);
+  int sysout = system(system_call.c_str());
+  return sysout;
 }
@@ -26,6 +26,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
 #include "mcp-basic.hpp"
 #include "mcp-sha3.hpp"
 #include "mcp-version.hpp"
@@ -109,8 +110,13 @@ int main (int argc, char **argv) {
     const string mod_file("mcp-" + module_string[module]);
     bool errflag = false;
 
-    for (short version = seine; version <= mekong; ++version) {
-      const string mv_file(mod_file + "-" + version_string[version]);
+    vector<string> versions(version_string + seine, version_string + mekong + 1);
+    if (module != trans)
+      for (const string &width : width_string)
+	versions.push_back(version_string[mekong] + width);
+
+    for (const string &mv_version : versions) {
+      const string mv_file(mod_file + "-" + mv_version);
       string whis;
       size_t pos = search_file(mv_file, whis);
       if (pos == string::npos) {
@@ -121,7 +127,7 @@ int main (int argc, char **argv) {
 	const string sha3 = sha3_file(whis);
 	// produce VERSION map
 	output << "  VERSION[\"" << module_string[module]
-	       << "\"][\""       << version_string[version]
+	       << "\"][\""       << mv_version
 	       << "\"] ="
 	       << endl
 	       << "\"" << sha3 << "\";" << endl << endl;